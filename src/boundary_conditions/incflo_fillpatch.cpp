@@ -172,6 +172,39 @@ void incflo::fillpatch_force (Real time, Vector<MultiFab*> const& force, int ng)
     }
 }
 
+// The running averages are not time dependent, so we fill from the single
+// copy in m_stats and extrapolate at physical boundaries like the forces
+void incflo::fillpatch_stats (int lev, Real time, MultiFab& stats, int ng)
+{
+    const int ncomp = stats.nComp();
+    const Vector<BCRec> bcrec(ncomp, get_force_bcrec()[0]);
+    if (lev == 0) {
+        PhysBCFunct<GpuBndryFuncFab<IncfloForFill> > physbc
+            (geom[lev], bcrec, IncfloForFill{m_probtype});
+        FillPatchSingleLevel(stats, IntVect(ng), time,
+                             {&(m_stats[lev])}, {time},
+                             0, 0, ncomp, geom[lev],
+                             physbc, 0);
+    } else {
+        PhysBCFunct<GpuBndryFuncFab<IncfloForFill> > cphysbc
+            (geom[lev-1], bcrec, IncfloForFill{m_probtype});
+        PhysBCFunct<GpuBndryFuncFab<IncfloForFill> > fphysbc
+            (geom[lev], bcrec, IncfloForFill{m_probtype});
+#ifdef AMREX_USE_EB
+        Interpolater* mapper = (EBFactory(0).isAllRegular()) ?
+            (Interpolater*)(&cell_cons_interp) : (Interpolater*)(&eb_cell_cons_interp);
+#else
+        Interpolater* mapper = &cell_cons_interp;
+#endif
+        FillPatchTwoLevels(stats, IntVect(ng), time,
+                           {&(m_stats[lev-1])}, {time},
+                           {&(m_stats[lev  ])}, {time},
+                           0, 0, ncomp, geom[lev-1], geom[lev],
+                           cphysbc, 0, fphysbc, 0,
+                           refRatio(lev-1), mapper, bcrec, 0);
+    }
+}
+
 void incflo::fillcoarsepatch_velocity (int lev, Real time, MultiFab& vel, int ng)
 {
     const auto& bcrec = get_velocity_bcrec();
@@ -253,3 +286,24 @@ void incflo::fillcoarsepatch_gradp (int lev, Real time, MultiFab& gp, int ng)
                                  cphysbc, 0, fphysbc, 0,
                                  refRatio(lev-1), mapper, bcrec, 0);
 }
+
+void incflo::fillcoarsepatch_stats (int lev, Real time, MultiFab& stats, int ng)
+{
+    const int ncomp = stats.nComp();
+    const Vector<BCRec> bcrec(ncomp, get_force_bcrec()[0]);
+    PhysBCFunct<GpuBndryFuncFab<IncfloForFill> > cphysbc
+        (geom[lev-1], bcrec, IncfloForFill{m_probtype});
+    PhysBCFunct<GpuBndryFuncFab<IncfloForFill> > fphysbc
+        (geom[lev], bcrec, IncfloForFill{m_probtype});
+#ifdef AMREX_USE_EB
+    Interpolater* mapper = (EBFactory(0).isAllRegular()) ?
+        (Interpolater*)(&cell_cons_interp) : (Interpolater*)(&eb_cell_cons_interp);
+#else
+    Interpolater* mapper = &cell_cons_interp;
+#endif
+    amrex::InterpFromCoarseLevel(stats, IntVect(ng), time,
+                                 m_stats[lev-1], 0, 0, ncomp,
+                                 geom[lev-1], geom[lev],
+                                 cphysbc, 0, fphysbc, 0,
+                                 refRatio(lev-1), mapper, bcrec, 0);
+}
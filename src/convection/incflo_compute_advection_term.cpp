@@ -45,6 +45,9 @@ incflo::compute_convective_term (Vector<MultiFab*> const& conv_u,
         if (m_use_godunov) {
             godunov::predict_godunov(lev, time, AMREX_D_DECL(*u_mac[lev], *v_mac[lev], *w_mac[lev]), *vel[lev], *vel_forces[lev],
                                      get_velocity_bcrec(), get_velocity_bcrec_device_ptr(), 
+#ifdef AMREX_USE_EB
+                                     ebfact,
+#endif
                                      Geom(), l_dt, m_godunov_ppm, m_godunov_use_forces_in_trans);
         } else {
 
@@ -59,30 +62,79 @@ incflo::compute_convective_term (Vector<MultiFab*> const& conv_u,
 
     apply_MAC_projection(AMREX_D_DECL(u_mac, v_mac, w_mac), density, time);
 
-    for (int lev = 0; lev <= finest_level; ++lev)
-    {
-        if (ngmac > 0) {
+    if (ngmac > 0) {
+        for (int lev = 0; lev <= finest_level; ++lev) {
             AMREX_D_TERM(u_mac[lev]->FillBoundary(geom[lev].periodicity());,
                          v_mac[lev]->FillBoundary(geom[lev].periodicity());,
                          w_mac[lev]->FillBoundary(geom[lev].periodicity()););
         }
+    }
+
+#ifdef AMREX_USE_EB
+    make_redistribution_data();
+
+    // With incflo.eb_local_halo the state only carries the halo of the regular boxes.
+    // The boxes near the EB read from copies with the wide halo, filled from the level
+    // data at this time instead of growing the halo of every box of the level.
+    Vector<MultiFab> vel_eb(finest_level+1), rho_eb(finest_level+1), tra_eb(finest_level+1);
+    if (m_eb_local_halo)
+    {
+        make_eb_halo_grids();
+        const int ng = nghost_state_eb();
+        for (int lev = 0; lev <= finest_level; ++lev)
+        {
+            BoxArray const& ba = m_eb_halo_grids[lev];
+            if (ba.empty()) continue;
+            DistributionMapping const& dm = m_eb_halo_dmap[lev];
+            EBFArrayBoxFactory const& fact = *m_eb_halo_fact[lev];
+            vel_eb[lev].define(ba, dm, AMREX_SPACEDIM, ng, MFInfo(), fact);
+            rho_eb[lev].define(ba, dm, 1, ng, MFInfo(), fact);
+            fillpatch_velocity(lev, time, vel_eb[lev], ng);
+            fillpatch_density(lev, time, rho_eb[lev], ng);
+            if (m_ntrac > 0) {
+                tra_eb[lev].define(ba, dm, m_ntrac, ng, MFInfo(), fact);
+                fillpatch_tracer(lev, time, tra_eb[lev], ng);
+            }
+        }
+    }
+#endif
 
-        MFItInfo mfi_info;
-        // if (Gpu::notInLaunchRegion()) mfi_info.EnableTiling(IntVect(1024,16,16)).SetDynamic(true);
-        if (Gpu::notInLaunchRegion()) mfi_info.EnableTiling(IntVect(AMREX_D_DECL(1024,1024,1024))).SetDynamic(true);
+    MFItInfo mfi_info;
+    // if (Gpu::notInLaunchRegion()) mfi_info.EnableTiling(IntVect(1024,16,16)).SetDynamic(true);
+    if (Gpu::notInLaunchRegion()) mfi_info.EnableTiling(IntVect(AMREX_D_DECL(1024,1024,1024)));
+
+    // The levels are independent from here on, so a single parallel region spans
+    // all of them and threads go on to the next level instead of forking and
+    // joining once per level. The tiles are assigned statically: dynamic MFIter
+    // scheduling synchronizes the threads at the start and end of every level.
 #ifdef _OPENMP
 #pragma omp parallel if (Gpu::notInLaunchRegion())
 #endif
+    for (int lev = 0; lev <= finest_level; ++lev)
+    {
         for (MFIter mfi(*density[lev],mfi_info); mfi.isValid(); ++mfi)
         {
             Box const& bx = mfi.tilebox();
+            Array4<Real const> velarr = vel[lev]->const_array(mfi);
+            Array4<Real const> rhoarr = density[lev]->const_array(mfi);
+            Array4<Real const> traarr = (m_ntrac>0) ? tracer[lev]->const_array(mfi)
+                                                    : Array4<Real const>{};
+#ifdef AMREX_USE_EB
+            if (m_eb_local_halo and !m_eb_halo_index[lev].empty())
+            {
+                const int ieb = m_eb_halo_index[lev][mfi.index()];
+                if (ieb >= 0) {
+                    velarr = vel_eb[lev][ieb].const_array();
+                    rhoarr = rho_eb[lev][ieb].const_array();
+                    if (m_ntrac > 0) traarr = tra_eb[lev][ieb].const_array();
+                }
+            }
+#endif
             compute_convective_term(bx, lev, mfi,
                                     conv_u[lev]->array(mfi),
                                     conv_r[lev]->array(mfi),
                                     (m_ntrac>0) ? conv_t[lev]->array(mfi) : Array4<Real>{},
-                                    vel[lev]->const_array(mfi),
-                                    density[lev]->array(mfi),
-                                    (m_ntrac>0) ? tracer[lev]->const_array(mfi) : Array4<Real const>{},
+                                    velarr, rhoarr, traarr,
                                     AMREX_D_DECL(u_mac[lev]->const_array(mfi),
                                                  v_mac[lev]->const_array(mfi),
                                                  w_mac[lev]->const_array(mfi)),
@@ -109,8 +161,6 @@ incflo::compute_convective_term (Box const& bx, int lev, MFIter const& mfi,
                                  Array4<Real const> const& ftra)
 {
 #ifdef AMREX_USE_EB
-    AMREX_ALWAYS_ASSERT(!m_use_godunov);
-
     auto const& fact = EBFactory(lev);
     EBCellFlagFab const& flagfab = fact.getMultiEBCellFlagFab()[mfi];
     Array4<EBCellFlag const> const& flag = flagfab.const_array();
@@ -132,7 +182,9 @@ incflo::compute_convective_term (Box const& bx, int lev, MFIter const& mfi,
         return;
     }
 
-    bool regular = (flagfab.getType(amrex::grow(bx,2)) == FabType::regular);
+    // Godunov with corner coupling reaches one cell further out than MOL
+    const int nreg = m_use_godunov ? 3 : 2;
+    bool regular = (flagfab.getType(amrex::grow(bx,nreg)) == FabType::regular);
 
     Array4<Real const> AMREX_D_DECL(fcx, fcy, fcz), ccc, vfrac, AMREX_D_DECL(apx, apy, apz);
     if (!regular) {
@@ -145,6 +197,8 @@ incflo::compute_convective_term (Box const& bx, int lev, MFIter const& mfi,
                      apy = fact.getAreaFrac()[1]->const_array(mfi);,
                      apz = fact.getAreaFrac()[2]->const_array(mfi););
     }
+#else
+    const bool regular = true;
 #endif
 
     Box rhotrac_box = amrex::grow(bx,2);
@@ -158,7 +212,7 @@ incflo::compute_convective_term (Box const& bx, int lev, MFIter const& mfi,
     Array4<Real> rhotrac;
     if (m_advect_tracer) {
         rhotracfab.resize(rhotrac_box, m_ntrac);
-        if (!m_use_godunov) {
+        if (!m_use_godunov or !regular) {
             eli_rt = rhotracfab.elixir();
         }
         rhotrac = rhotracfab.array();
@@ -172,7 +226,7 @@ incflo::compute_convective_term (Box const& bx, int lev, MFIter const& mfi,
     int nmaxcomp = AMREX_SPACEDIM;
     if (m_advect_tracer) nmaxcomp = std::max(nmaxcomp,m_ntrac);
 
-    if (m_use_godunov)
+    if (m_use_godunov and regular)
     {
 #if (AMREX_SPACEDIM == 3)
         FArrayBox tmpfab(amrex::grow(bx,1), nmaxcomp*14+1);
@@ -233,41 +287,84 @@ incflo::compute_convective_term (Box const& bx, int lev, MFIter const& mfi,
         {
             Array4<Real> scratch = tmpfab.array(0);
             Array4<Real> dUdt_tmp = tmpfab.array(nmaxcomp*AMREX_SPACEDIM);
+            Array4<Real const> const& vinv = m_redist_vinv[lev]->const_array(mfi);
+            Array4<int const> itracker;
+            Array4<Real const> srd;
+            if (m_state_redist) {
+                itracker = m_srd_itracker[lev]->const_array(mfi);
+                srd = m_srd_data[lev]->const_array(mfi);
+            }
+            auto redistribute = [&] (int ncomp, Array4<Real> const& dUdt, Array4<Real const> const& U)
+            {
+                if (m_state_redist) {
+                    redistribute_state_eb(bx, ncomp, dUdt, dUdt_tmp, U, scratch, flag, vfrac,
+                                          itracker, srd, m_dt);
+                } else {
+                    redistribute_eb(lev, bx, ncomp, dUdt, dUdt_tmp, scratch, flag, vfrac, vinv, rho);
+                }
+            };
 
             // velocity
-            mol::compute_convective_fluxes_eb(lev, gbx, AMREX_SPACEDIM,
-                                              AMREX_D_DECL(fx, fy, fz), vel, 
-                                              AMREX_D_DECL(umac, vmac, wmac),
-                                              get_velocity_bcrec().data(),
-                                              get_velocity_bcrec_device_ptr(),
-                                              flag, AMREX_D_DECL(fcx, fcy, fcz), ccc, Geom());
+            if (m_use_godunov) {
+                godunov::compute_godunov_fluxes_eb(lev, gbx, AMREX_SPACEDIM,
+                                                   AMREX_D_DECL(fx, fy, fz), vel,
+                                                   AMREX_D_DECL(umac, vmac, wmac), fvel,
+                                                   get_velocity_bcrec_device_ptr(),
+                                                   flag, AMREX_D_DECL(fcx, fcy, fcz), ccc,
+                                                   Geom(), m_dt);
+            } else {
+                mol::compute_convective_fluxes_eb(lev, gbx, AMREX_SPACEDIM,
+                                                  AMREX_D_DECL(fx, fy, fz), vel, 
+                                                  AMREX_D_DECL(umac, vmac, wmac),
+                                                  get_velocity_bcrec().data(),
+                                                  get_velocity_bcrec_device_ptr(),
+                                                  flag, AMREX_D_DECL(fcx, fcy, fcz), ccc, Geom());
+            }
             mol::compute_convective_rate_eb(lev, gbx, AMREX_SPACEDIM, dUdt_tmp, AMREX_D_DECL(fx, fy, fz),
                                             flag, vfrac, AMREX_D_DECL(apx, apy, apz), Geom());
-            redistribute_eb(lev, bx, AMREX_SPACEDIM, dvdt, dUdt_tmp, scratch, flag, vfrac);
+            redistribute(AMREX_SPACEDIM, dvdt, vel);
 
             // density
             if (!m_constant_density) {
-                mol::compute_convective_fluxes_eb(lev, gbx, 1,
-                                                  AMREX_D_DECL(fx, fy, fz), rho, 
-                                                  AMREX_D_DECL(umac, vmac, wmac),
-                                                  get_density_bcrec().data(),
-                                                  get_density_bcrec_device_ptr(),
-                                                  flag, AMREX_D_DECL(fcx, fcy, fcz), ccc, Geom());
+                if (m_use_godunov) {
+                    godunov::compute_godunov_fluxes_eb(lev, gbx, 1,
+                                                       AMREX_D_DECL(fx, fy, fz), rho,
+                                                       AMREX_D_DECL(umac, vmac, wmac), {},
+                                                       get_density_bcrec_device_ptr(),
+                                                       flag, AMREX_D_DECL(fcx, fcy, fcz), ccc,
+                                                       Geom(), m_dt);
+                } else {
+                    mol::compute_convective_fluxes_eb(lev, gbx, 1,
+                                                      AMREX_D_DECL(fx, fy, fz), rho, 
+                                                      AMREX_D_DECL(umac, vmac, wmac),
+                                                      get_density_bcrec().data(),
+                                                      get_density_bcrec_device_ptr(),
+                                                      flag, AMREX_D_DECL(fcx, fcy, fcz), ccc, Geom());
+                }
                 mol::compute_convective_rate_eb(lev, gbx, 1, dUdt_tmp, AMREX_D_DECL(fx, fy, fz),
                                                 flag, vfrac, AMREX_D_DECL(apx, apy, apz), Geom());
-                redistribute_eb(lev, bx, 1, drdt, dUdt_tmp, scratch, flag, vfrac);
+                redistribute(1, drdt, rho);
             }
 
             if (m_advect_tracer) {
-                mol::compute_convective_fluxes_eb(lev, gbx, m_ntrac,
-                                                  AMREX_D_DECL(fx, fy, fz), rhotrac, 
-                                                  AMREX_D_DECL(umac, vmac, wmac),
-                                                  get_tracer_bcrec().data(),
-                                                  get_tracer_bcrec_device_ptr(),
-                                                  flag, AMREX_D_DECL(fcx, fcy, fcz), ccc, Geom());
+                if (m_use_godunov) {
+                    godunov::compute_godunov_fluxes_eb(lev, gbx, m_ntrac,
+                                                       AMREX_D_DECL(fx, fy, fz), rhotrac,
+                                                       AMREX_D_DECL(umac, vmac, wmac), ftra,
+                                                       get_tracer_bcrec_device_ptr(),
+                                                       flag, AMREX_D_DECL(fcx, fcy, fcz), ccc,
+                                                       Geom(), m_dt);
+                } else {
+                    mol::compute_convective_fluxes_eb(lev, gbx, m_ntrac,
+                                                      AMREX_D_DECL(fx, fy, fz), rhotrac, 
+                                                      AMREX_D_DECL(umac, vmac, wmac),
+                                                      get_tracer_bcrec().data(),
+                                                      get_tracer_bcrec_device_ptr(),
+                                                      flag, AMREX_D_DECL(fcx, fcy, fcz), ccc, Geom());
+                }
                 mol::compute_convective_rate_eb(lev, gbx, m_ntrac, dUdt_tmp, AMREX_D_DECL(fx, fy, fz),
                                                 flag, vfrac, AMREX_D_DECL(apx, apy, apz), Geom());
-                redistribute_eb(lev, bx, m_ntrac, dtdt, dUdt_tmp, scratch, flag, vfrac);
+                redistribute(m_ntrac, dtdt, rhotrac);
             }
         }
         else
@@ -371,34 +468,98 @@ mol::compute_convective_rate_eb (int lev, Box const& bx, int ncomp,
     });
 }
 
+//
+// Build the inverse of the volume of the connected neighbours (inside the domain) of
+// each cut cell. It only depends on the EB and the grids, so it is computed once per
+// grid hierarchy instead of once per component in every call of redistribute_eb.
+//
+void incflo::make_redistribution_data ()
+{
+    m_redist_vinv.resize(finest_level+1);
+    for (int lev = 0; lev <= finest_level; ++lev)
+    {
+        if (m_redist_vinv[lev]) continue;
+
+        auto const& fact = EBFactory(lev);
+        auto const& flags = fact.getMultiEBCellFlagFab();
+        auto const& volfrac = fact.getVolFrac();
+        const Box dbox = Geom(lev).growPeriodicDomain(2);
+
+        if (m_state_redist) {
+            make_state_redistribution_data(lev);
+        }
+
+        m_redist_vinv[lev].reset(new MultiFab(grids[lev], dmap[lev], 1, 1));
+        MultiFab& vinv_mf = *m_redist_vinv[lev];
+
+#ifdef _OPENMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+        for (MFIter mfi(vinv_mf,TilingIfNotGPU()); mfi.isValid(); ++mfi)
+        {
+            Box const& bx = mfi.growntilebox();
+            Array4<Real> const& vinv = vinv_mf.array(mfi);
+            EBCellFlagFab const& flagfab = flags[mfi];
+            if (flagfab.getType(bx) != FabType::singlevalued) {
+                amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+                {
+                    vinv(i,j,k) = 0.0;
+                });
+                continue;
+            }
+
+            Array4<EBCellFlag const> const& flag = flagfab.const_array();
+            Array4<Real const> const& vfrac = volfrac.const_array(mfi);
+            amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+            {
+                Real vtot = 0.0;
+                if (flag(i,j,k).isSingleValued()) {
+                    for (int kk = -1; kk <= 1; ++kk) {
+                    for (int jj = -1; jj <= 1; ++jj) {
+                    for (int ii = -1; ii <= 1; ++ii) {
+                        if ((ii != 0 or jj != 0 or kk != 0) and
+                            flag(i,j,k).isConnected(ii,jj,kk) and
+                            dbox.contains(IntVect(AMREX_D_DECL(i+ii,j+jj,k+kk))))
+                        {
+                            vtot += vfrac(i+ii,j+jj,k+kk);
+                        }
+                    }}}
+                }
+                vinv(i,j,k) = 1.0/(vtot + 1.e-80);
+            });
+        }
+    }
+}
+
+//
+// Flux redistribution: each cut cell keeps the conservative divergence weighted by its
+// volume fraction and hands the mass it misses to its connected neighbours. The
+// neighbours gather their share, rather than the cut cells scattering it, so that
+// there are no atomic updates and the result does not depend on the thread order.
+// The share of a neighbour is proportional to its volume, or to its mass when
+// incflo.redistribution_weight = density.
+//
 void incflo::redistribute_eb (int lev, Box const& bx, int ncomp,
                               Array4<Real> const& dUdt,
                               Array4<Real const> const& dUdt_in,
                               Array4<Real> const& scratch,
                               Array4<EBCellFlag const> const& flag,
-                              Array4<Real const> const& vfrac)
+                              Array4<Real const> const& vfrac,
+                              Array4<Real const> const& vinv,
+                              Array4<Real const> const& rho)
 {
     const Box dbox = Geom(lev).growPeriodicDomain(2);
+    const bool rho_weighted = m_redist_density_weighted;
 
-    Array4<Real> tmp(scratch, 0);
-    Array4<Real> delm(scratch, ncomp);
-    Array4<Real> wgt(scratch, 2*ncomp);
+    Array4<Real> optmp(scratch, 0);
+    Array4<Real> rinv(scratch, ncomp);
 
     Box const& bxg1 = amrex::grow(bx,1);
-    Box const& bxg2 = amrex::grow(bx,2);
-
-    // xxxxx TODO: more weight options
-    amrex::ParallelFor(bxg2,
-    [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
-    {
-        wgt(i,j,k) = (dbox.contains(IntVect(AMREX_D_DECL(i,j,k)))) ? 1.0 : 0.0;
-    });
 
     amrex::ParallelFor(bxg1, ncomp,
     [=] AMREX_GPU_DEVICE (int i, int j, int k, int n) noexcept
     {
         if (flag(i,j,k).isSingleValued()) {
-            Real vtot = 0.0;
             Real divnc = 0.0;
             for (int kk = -1; kk <= 1; ++kk) {
             for (int jj = -1; jj <= 1; ++jj) {
@@ -407,54 +568,144 @@ void incflo::redistribute_eb (int lev, Box const& bx, int ncomp,
                     flag(i,j,k).isConnected(ii,jj,kk) and
                     dbox.contains(IntVect(AMREX_D_DECL(i+ii,j+jj,k+kk))))
                 {
-                    Real vf = vfrac(i+ii,j+jj,k+kk);
-                    vtot += vf;
-                    divnc += vf * dUdt_in(i+ii,j+jj,k+kk,n);
+                    divnc += vfrac(i+ii,j+jj,k+kk) * dUdt_in(i+ii,j+jj,k+kk,n);
                 }
             }}}
-            divnc /= (vtot + 1.e-80);
-            Real optmp = (1.0-vfrac(i,j,k))*(divnc-dUdt_in(i,j,k,n));
-            tmp(i,j,k,n) = optmp;
-            delm(i,j,k,n) = -vfrac(i,j,k)*optmp;
+            divnc *= vinv(i,j,k);
+            optmp(i,j,k,n) = (1.0-vfrac(i,j,k))*(divnc-dUdt_in(i,j,k,n));
         } else {
-            tmp(i,j,k,n) = 0.0;
+            optmp(i,j,k,n) = 0.0;
         }
     });
 
-    amrex::ParallelFor(bxg1 & dbox, ncomp,
-    [=] AMREX_GPU_DEVICE (int i, int j, int k, int n) noexcept
-    {
-        if (flag(i,j,k).isSingleValued()) {
+    // Inverse of the total weight of the neighbours of each cut cell
+    Array4<Real const> winv = vinv;
+    if (rho_weighted) {
+        amrex::ParallelFor(bxg1,
+        [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+        {
             Real wtot = 0.0;
-            for (int kk = -1; kk <= 1; ++kk) {
-            for (int jj = -1; jj <= 1; ++jj) {
-            for (int ii = -1; ii <= 1; ++ii) {
-                if ((ii != 0 or jj != 0 or kk != 0) and
-                    flag(i,j,k).isConnected(ii,jj,kk))
-                {
-                    wtot += vfrac(i+ii,j+jj,k+kk) * wgt(i+ii,j+jj,k+kk);
-                }
-            }}}
-            wtot = 1.0/(wtot+1.e-80);
-
-            Real dtmp = delm(i,j,k,n) * wtot;
-            for (int kk = -1; kk <= 1; ++kk) {
-            for (int jj = -1; jj <= 1; ++jj) {
-            for (int ii = -1; ii <= 1; ++ii) {
-                if ((ii != 0 or jj != 0 or kk != 0) and
-                    bx.contains(IntVect(AMREX_D_DECL(i+ii,j+jj,k+kk))) and
-                    flag(i,j,k).isConnected(ii,jj,kk))
-                {
-                    Gpu::Atomic::Add(&tmp(i+ii,j+jj,k+kk,n), dtmp*wgt(i+ii,j+jj,k+kk));
-                }
-            }}}
-        }
-    });
+            if (flag(i,j,k).isSingleValued()) {
+                for (int kk = -1; kk <= 1; ++kk) {
+                for (int jj = -1; jj <= 1; ++jj) {
+                for (int ii = -1; ii <= 1; ++ii) {
+                    if ((ii != 0 or jj != 0 or kk != 0) and
+                        flag(i,j,k).isConnected(ii,jj,kk) and
+                        dbox.contains(IntVect(AMREX_D_DECL(i+ii,j+jj,k+kk))))
+                    {
+                        wtot += vfrac(i+ii,j+jj,k+kk) * rho(i+ii,j+jj,k+kk);
+                    }
+                }}}
+            }
+            rinv(i,j,k) = 1.0/(wtot + 1.e-80);
+        });
+        winv = rinv;
+    }
 
+    // The connectivity between two cells is symmetric, so the flag of the receiving
+    // cell tells which cut cells it takes a share from
     amrex::ParallelFor(bx, ncomp,
     [=] AMREX_GPU_DEVICE (int i, int j, int k, int n) noexcept
     {
-        dUdt(i,j,k,n) = dUdt_in(i,j,k,n) + tmp(i,j,k,n);
+        Real delm = 0.0;
+        for (int kk = -1; kk <= 1; ++kk) {
+        for (int jj = -1; jj <= 1; ++jj) {
+        for (int ii = -1; ii <= 1; ++ii) {
+            if ((ii != 0 or jj != 0 or kk != 0) and
+                flag(i,j,k).isConnected(ii,jj,kk) and
+                flag(i+ii,j+jj,k+kk).isSingleValued() and
+                dbox.contains(IntVect(AMREX_D_DECL(i+ii,j+jj,k+kk))))
+            {
+                delm -= vfrac(i+ii,j+jj,k+kk) * optmp(i+ii,j+jj,k+kk,n) * winv(i+ii,j+jj,k+kk);
+            }
+        }}}
+        const Real wgt = rho_weighted ? rho(i,j,k) : 1.0;
+        dUdt(i,j,k,n) = dUdt_in(i,j,k,n) + optmp(i,j,k,n) + delm*wgt;
     });
 }
+
+//
+// Find the boxes whose advection reads cut cells, for incflo.eb_local_halo. Only these
+// get a copy of the state with the wide halo during the advection; the halo of the
+// state itself stays that of the regular boxes.
+//
+void incflo::make_eb_halo_grids ()
+{
+    if (static_cast<int>(m_eb_halo_index.size()) == finest_level+1) return;
+
+    m_eb_halo_grids.resize(finest_level+1);
+    m_eb_halo_dmap.resize(finest_level+1);
+    m_eb_halo_fact.resize(finest_level+1);
+    m_eb_halo_index.resize(finest_level+1);
+
+    // Same test as for the regular tiles in compute_convective_term
+    const int nreg = m_use_godunov ? 3 : 2;
+    const int ng_narrow = nghost_state();
+    const int ng_wide = nghost_state_eb();
+    const int ncomp = AMREX_SPACEDIM + 1 + m_ntrac;
+
+    for (int lev = 0; lev <= finest_level; ++lev)
+    {
+        BoxArray const& ba = grids[lev];
+        DistributionMapping const& dm = dmap[lev];
+        auto const& flags = EBFactory(lev).getMultiEBCellFlagFab();
+
+        Vector<int> near_eb(ba.size(), 0);
+        for (MFIter mfi(flags); mfi.isValid(); ++mfi)
+        {
+            const FabType typ = flags[mfi].getType(amrex::grow(mfi.validbox(),nreg));
+            if (typ != FabType::regular and typ != FabType::covered) {
+                near_eb[mfi.index()] = 1;
+            }
+        }
+        ParallelDescriptor::ReduceIntSum(near_eb.data(), near_eb.size());
+
+        BoxList bl;
+        Vector<int> pmap;
+        Vector<int>& index = m_eb_halo_index[lev];
+        index.assign(ba.size(), -1);
+        Long npts_narrow = 0, npts_wide = 0, npts_copy = 0;
+        for (int i = 0; i < ba.size(); ++i)
+        {
+            npts_narrow += amrex::grow(ba[i],ng_narrow).numPts();
+            npts_wide += amrex::grow(ba[i],ng_wide).numPts();
+            if (near_eb[i]) {
+                index[i] = pmap.size();
+                bl.push_back(ba[i]);
+                pmap.push_back(dm[i]);
+                npts_copy += amrex::grow(ba[i],ng_wide).numPts();
+            }
+        }
+
+        if (pmap.empty()) {
+            m_eb_halo_grids[lev] = BoxArray();
+            m_eb_halo_dmap[lev] = DistributionMapping();
+            m_eb_halo_fact[lev].reset();
+        } else {
+            m_eb_halo_grids[lev] = BoxArray(bl);
+            m_eb_halo_dmap[lev] = DistributionMapping(pmap);
+            // The copies are filled with the EB-aware interpolation from the coarser
+            // level, which needs the EB data of the destination
+            m_eb_halo_fact[lev] = makeEBFabFactory(geom[lev], m_eb_halo_grids[lev],
+                                                   m_eb_halo_dmap[lev],
+                                                   {nghost_eb_basic(),
+                                                    nghost_eb_volume(),
+                                                    nghost_eb_full()},
+                                                   EBSupport::full);
+        }
+
+        // Printed whenever the local halo is on, so that the saving is on record
+        {
+            // Old and new velocity, density and tracers, and one set of copies
+            const Real mb = Real(sizeof(Real)) / (1024.*1024.);
+            amrex::Print() << "EB local halo on level " << lev << ": "
+                           << pmap.size() << " of " << ba.size() << " boxes near the EB\n"
+                           << "    state with " << ng_narrow << " ghost cells: "
+                           << 2*ncomp*npts_narrow*mb << " MB, copies with "
+                           << ng_wide << " ghost cells: " << ncomp*npts_copy*mb << " MB\n"
+                           << "    state with " << ng_wide << " ghost cells everywhere: "
+                           << 2*ncomp*npts_wide*mb << " MB" << std::endl;
+        }
+    }
+}
 #endif
@@ -0,0 +1,291 @@
+#include <incflo_slopes_K.H>
+#include <Godunov.H>
+
+using namespace amrex;
+
+#ifdef AMREX_USE_EB
+namespace {
+
+AMREX_GPU_DEVICE AMREX_FORCE_INLINE
+bool extdir_or_ho (int bc) noexcept
+{
+    return (bc == BCType::ext_dir) or (bc == BCType::hoextrap);
+}
+
+//
+// Extrapolate component n of q from the centroid of cell (i,j,k) to the point xf
+// (in cell units, relative to the cell centre) and half a time step forward in time.
+// The EB-aware least-squares slopes are used in all directions, and cfl holds the
+// Courant numbers u_d dt / dx_d of the cell.
+//
+AMREX_GPU_DEVICE AMREX_FORCE_INLINE
+Real eb_extrap (int i, int j, int k, int n,
+                Array4<Real const> const& q,
+                Array4<Real const> const& ccc,
+                Array4<EBCellFlag const> const& flag,
+                BCRec const& bc, Dim3 const& dlo, Dim3 const& dhi,
+                GpuArray<Real,AMREX_SPACEDIM> const& xf,
+                GpuArray<Real,AMREX_SPACEDIM> const& cfl) noexcept
+{
+    const auto slopes = incflo_slopes_extdir_eb(i,j,k,n,q,ccc,flag,
+                        AMREX_D_DECL(extdir_or_ho(bc.lo(0)), extdir_or_ho(bc.lo(1)), extdir_or_ho(bc.lo(2))),
+                        AMREX_D_DECL(extdir_or_ho(bc.hi(0)), extdir_or_ho(bc.hi(1)), extdir_or_ho(bc.hi(2))),
+                        AMREX_D_DECL(dlo.x, dlo.y, dlo.z),
+                        AMREX_D_DECL(dhi.x, dhi.y, dhi.z));
+    Real r = q(i,j,k,n);
+    for (int d = 0; d < AMREX_SPACEDIM; ++d) {
+        r += (xf[d] - ccc(i,j,k,d) - Real(0.5)*cfl[d]) * slopes[d];
+    }
+    return r;
+}
+
+//
+// States of component n on either side of the dir-face (i,j,k) at the face centroid
+// and t^{n+1/2}. qm comes from the cell on the low side and qp from the cell on the
+// high side. Both are limited by the values in the two cells and get half a time
+// step of the forcing f, if there is one. At an ext_dir domain face both are set to
+// the boundary value.
+//
+template <int dir>
+AMREX_GPU_DEVICE AMREX_FORCE_INLINE
+void eb_face_states (int i, int j, int k, int n,
+                     Array4<Real const> const& q,
+                     Array4<Real const> const& vcc,
+                     Array4<Real const> const& f,
+                     Array4<Real const> const& ccc,
+                     Array4<EBCellFlag const> const& flag,
+                     Array4<Real const> const& fc,
+                     BCRec const& bc, Dim3 const& dlo, Dim3 const& dhi,
+                     GpuArray<Real,AMREX_SPACEDIM> const& dtdx, Real dt,
+                     Real& qm, Real& qp) noexcept
+{
+    const int im = i - (dir == 0);
+    const int jm = j - (dir == 1);
+    const int km = k - (dir == 2);
+
+    const int ii    = (dir == 0) ? i     : ((dir == 1) ? j     : k);
+    const int domlo = (dir == 0) ? dlo.x : ((dir == 1) ? dlo.y : dlo.z);
+    const int domhi = (dir == 0) ? dhi.x : ((dir == 1) ? dhi.y : dhi.z);
+
+    if (ii <= domlo and bc.lo(dir) == BCType::ext_dir) {
+        qm = qp = q(i-(dir==0)*(i-domlo+1), j-(dir==1)*(j-domlo+1), k-(dir==2)*(k-domlo+1), n);
+        return;
+    } else if (ii >= domhi+1 and bc.hi(dir) == BCType::ext_dir) {
+        qm = qp = q(i-(dir==0)*(i-domhi-1), j-(dir==1)*(j-domhi-1), k-(dir==2)*(k-domhi-1), n);
+        return;
+    }
+
+    // Face centroid relative to the centre of the cell on the high side; the face
+    // centroid data holds the tangential coordinates in increasing direction order
+    GpuArray<Real,AMREX_SPACEDIM> xf;
+    for (int d = 0, m = 0; d < AMREX_SPACEDIM; ++d) {
+        xf[d] = (d == dir) ? Real(-0.5) : fc(i,j,k,m++);
+    }
+
+    GpuArray<Real,AMREX_SPACEDIM> cflp, cflm;
+    for (int d = 0; d < AMREX_SPACEDIM; ++d) {
+        cflp[d] = vcc(i ,j ,k ,d) * dtdx[d];
+        cflm[d] = vcc(im,jm,km,d) * dtdx[d];
+    }
+
+    qp = eb_extrap(i,j,k,n,q,ccc,flag,bc,dlo,dhi,xf,cflp);
+    xf[dir] = Real(0.5);
+    qm = eb_extrap(im,jm,km,n,q,ccc,flag,bc,dlo,dhi,xf,cflm);
+
+    const Real qmax = amrex::max(q(i,j,k,n), q(im,jm,km,n));
+    const Real qmin = amrex::min(q(i,j,k,n), q(im,jm,km,n));
+    qp = amrex::max(amrex::min(qp, qmax), qmin);
+    qm = amrex::max(amrex::min(qm, qmax), qmin);
+
+    if (f) {
+        qp += Real(0.5)*dt*f(i ,j ,k ,n);
+        qm += Real(0.5)*dt*f(im,jm,km,n);
+    }
+}
+
+AMREX_GPU_DEVICE AMREX_FORCE_INLINE
+Real eb_riemann_normal_vel (Real um, Real up) noexcept
+{
+    Real u = 0.0;
+    if (um >= 0.0 or up <= 0.0) {
+        const Real avg = Real(0.5)*(um + up);
+        if (avg >= godunov::small_vel) {
+            u = um;
+        } else if (avg <= -godunov::small_vel) {
+            u = up;
+        }
+    }
+    return u;
+}
+
+AMREX_GPU_DEVICE AMREX_FORCE_INLINE
+Real eb_upwind (Real qm, Real qp, Real umac) noexcept
+{
+    if (umac > godunov::small_vel) {
+        return qm;
+    } else if (umac < -godunov::small_vel) {
+        return qp;
+    } else {
+        return Real(0.5)*(qm + qp);
+    }
+}
+
+}
+
+//
+// Predict the normal velocities on the face centroids of a tile that touches the EB.
+// There is no corner transport upwind coupling near cut cells: the states are
+// extrapolated in space with the EB-aware slopes and in time with the full
+// (u.grad) u of the cell, and the Riemann problem is solved as in the MOL predictor.
+//
+void
+godunov::predict_godunov_on_box_eb (int lev,
+                                    AMREX_D_DECL(Box const& xbx,
+                                                 Box const& ybx,
+                                                 Box const& zbx),
+                                    AMREX_D_DECL(Array4<Real> const& qx,
+                                                 Array4<Real> const& qy,
+                                                 Array4<Real> const& qz),
+                                    Array4<Real const> const& vel,
+                                    Array4<Real const> const& f,
+                                    Array4<EBCellFlag const> const& flag,
+                                    AMREX_D_DECL(Array4<Real const> const& fcx,
+                                                 Array4<Real const> const& fcy,
+                                                 Array4<Real const> const& fcz),
+                                    Array4<Real const> const& ccc,
+                                    BCRec const* pbc,
+                                    Vector<Geometry> geom,
+                                    Real l_dt)
+{
+    Box const& domain = geom[lev].Domain();
+    const Dim3 dlo = amrex::lbound(domain);
+    const Dim3 dhi = amrex::ubound(domain);
+    const auto dxinv = geom[lev].InvCellSizeArray();
+    GpuArray<Real,AMREX_SPACEDIM> dtdx;
+    for (int d = 0; d < AMREX_SPACEDIM; ++d) {
+        dtdx[d] = l_dt*dxinv[d];
+    }
+
+#if (AMREX_SPACEDIM == 3)
+    amrex::ParallelFor(xbx, ybx, zbx,
+#else
+    amrex::ParallelFor(xbx, ybx,
+#endif
+    [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+    {
+        Real um, up;
+        qx(i,j,k) = 0.0;
+        if (flag(i,j,k).isConnected(-1,0,0)) {
+            eb_face_states<0>(i,j,k,0,vel,vel,f,ccc,flag,fcx,pbc[0],dlo,dhi,dtdx,l_dt,um,up);
+            qx(i,j,k) = eb_riemann_normal_vel(um, up);
+        }
+    },
+    [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+    {
+        Real um, up;
+        qy(i,j,k) = 0.0;
+        if (flag(i,j,k).isConnected(0,-1,0)) {
+            eb_face_states<1>(i,j,k,1,vel,vel,f,ccc,flag,fcy,pbc[1],dlo,dhi,dtdx,l_dt,um,up);
+            qy(i,j,k) = eb_riemann_normal_vel(um, up);
+        }
+#if (AMREX_SPACEDIM == 3)
+    },
+    [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+    {
+        Real um, up;
+        qz(i,j,k) = 0.0;
+        if (flag(i,j,k).isConnected(0,0,-1)) {
+            eb_face_states<2>(i,j,k,2,vel,vel,f,ccc,flag,fcz,pbc[2],dlo,dhi,dtdx,l_dt,um,up);
+            qz(i,j,k) = eb_riemann_normal_vel(um, up);
+        }
+#endif
+    });
+}
+
+//
+// Upwind fluxes umac*q^{n+1/2} on the face centroids of bx for a tile that touches
+// the EB. The time extrapolation uses the cell-centred average of the (projected)
+// MAC velocities. All components are advanced in conservative form here, as in the
+// MOL EB path, so that the fluxes can go through the EB flux divergence and
+// redistribution.
+//
+void
+godunov::compute_godunov_fluxes_eb (int lev, Box const& bx, int ncomp,
+                                    AMREX_D_DECL(Array4<Real> const& fx,
+                                                 Array4<Real> const& fy,
+                                                 Array4<Real> const& fz),
+                                    Array4<Real const> const& q,
+                                    AMREX_D_DECL(Array4<Real const> const& umac,
+                                                 Array4<Real const> const& vmac,
+                                                 Array4<Real const> const& wmac),
+                                    Array4<Real const> const& fq,
+                                    BCRec const* pbc,
+                                    Array4<EBCellFlag const> const& flag,
+                                    AMREX_D_DECL(Array4<Real const> const& fcx,
+                                                 Array4<Real const> const& fcy,
+                                                 Array4<Real const> const& fcz),
+                                    Array4<Real const> const& ccc,
+                                    Vector<Geometry> geom,
+                                    Real l_dt)
+{
+    Box const& domain = geom[lev].Domain();
+    const Dim3 dlo = amrex::lbound(domain);
+    const Dim3 dhi = amrex::ubound(domain);
+    const auto dxinv = geom[lev].InvCellSizeArray();
+    GpuArray<Real,AMREX_SPACEDIM> dtdx;
+    for (int d = 0; d < AMREX_SPACEDIM; ++d) {
+        dtdx[d] = l_dt*dxinv[d];
+    }
+
+    // Cell-centred advection velocity for the time extrapolation
+    Box const& bxg1 = amrex::grow(bx,1);
+    FArrayBox uccfab(bxg1, AMREX_SPACEDIM);
+    Elixir eli = uccfab.elixir();
+    Array4<Real> const& ucc = uccfab.array();
+    amrex::ParallelFor(bxg1, [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+    {
+        AMREX_D_TERM(ucc(i,j,k,0) = Real(0.5)*(umac(i,j,k) + umac(i+1,j,k));,
+                     ucc(i,j,k,1) = Real(0.5)*(vmac(i,j,k) + vmac(i,j+1,k));,
+                     ucc(i,j,k,2) = Real(0.5)*(wmac(i,j,k) + wmac(i,j,k+1)););
+    });
+
+    AMREX_D_TERM(Box const& xbx = amrex::surroundingNodes(bx,0);,
+                 Box const& ybx = amrex::surroundingNodes(bx,1);,
+                 Box const& zbx = amrex::surroundingNodes(bx,2););
+
+#if (AMREX_SPACEDIM == 3)
+    amrex::ParallelFor(xbx, ncomp, ybx, ncomp, zbx, ncomp,
+#else
+    amrex::ParallelFor(xbx, ncomp, ybx, ncomp,
+#endif
+    [=] AMREX_GPU_DEVICE (int i, int j, int k, int n) noexcept
+    {
+        Real qm, qp;
+        fx(i,j,k,n) = 0.0;
+        if (flag(i,j,k).isConnected(-1,0,0)) {
+            eb_face_states<0>(i,j,k,n,q,ucc,fq,ccc,flag,fcx,pbc[n],dlo,dhi,dtdx,l_dt,qm,qp);
+            fx(i,j,k,n) = umac(i,j,k) * eb_upwind(qm, qp, umac(i,j,k));
+        }
+    },
+    [=] AMREX_GPU_DEVICE (int i, int j, int k, int n) noexcept
+    {
+        Real qm, qp;
+        fy(i,j,k,n) = 0.0;
+        if (flag(i,j,k).isConnected(0,-1,0)) {
+            eb_face_states<1>(i,j,k,n,q,ucc,fq,ccc,flag,fcy,pbc[n],dlo,dhi,dtdx,l_dt,qm,qp);
+            fy(i,j,k,n) = vmac(i,j,k) * eb_upwind(qm, qp, vmac(i,j,k));
+        }
+#if (AMREX_SPACEDIM == 3)
+    },
+    [=] AMREX_GPU_DEVICE (int i, int j, int k, int n) noexcept
+    {
+        Real qm, qp;
+        fz(i,j,k,n) = 0.0;
+        if (flag(i,j,k).isConnected(0,0,-1)) {
+            eb_face_states<2>(i,j,k,n,q,ucc,fq,ccc,flag,fcz,pbc[n],dlo,dhi,dtdx,l_dt,qm,qp);
+            fz(i,j,k,n) = wmac(i,j,k) * eb_upwind(qm, qp, wmac(i,j,k));
+        }
+#endif
+    });
+}
+#endif
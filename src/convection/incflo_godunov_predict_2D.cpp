@@ -10,6 +10,9 @@ void godunov::predict_godunov (int lev, Real time, MultiFab& u_mac, MultiFab& v_
                                MultiFab const& vel, MultiFab const& vel_forces,
                                Vector<BCRec> const& h_bcrec,
                                       BCRec  const* d_bcrec,
+#ifdef AMREX_USE_EB
+                               EBFArrayBoxFactory const* ebfact,
+#endif
                                Vector<Geometry> geom, Real l_dt, 
                                bool use_ppm, bool use_forces_in_trans)
 {
@@ -17,6 +20,13 @@ void godunov::predict_godunov (int lev, Real time, MultiFab& u_mac, MultiFab& v_
     const Real* dx    = geom[lev].CellSize();
 
     const int ncomp = AMREX_SPACEDIM;
+
+#ifdef AMREX_USE_EB
+    auto const& flags = ebfact->getMultiEBCellFlagFab();
+    auto const& fcent = ebfact->getFaceCent();
+    auto const& ccent = ebfact->getCentroid();
+#endif
+
 #ifdef _OPENMP
 #pragma omp parallel if (Gpu::notInLaunchRegion())
 #endif
@@ -34,6 +44,30 @@ void godunov::predict_godunov (int lev, Real time, MultiFab& u_mac, MultiFab& v_
             Array4<Real const> const& a_vel = vel.const_array(mfi);
             Array4<Real const> const& a_f = vel_forces.const_array(mfi);
 
+#ifdef AMREX_USE_EB
+            // The PLM/PPM predictor with corner coupling reaches three cells out,
+            // tiles closer than that to the EB use the cut-cell aware predictor
+            EBCellFlagFab const& flagfab = flags[mfi];
+            auto const typ = flagfab.getType(amrex::grow(bx,3));
+            if (typ == FabType::covered)
+            {
+                amrex::ParallelFor(xbx, ybx,
+                [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept { a_umac(i,j,k) = 0.0; },
+                [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept { a_vmac(i,j,k) = 0.0; });
+                continue;
+            }
+            else if (typ == FabType::singlevalued)
+            {
+                Array4<Real const> const& fcx = fcent[0]->const_array(mfi);
+                Array4<Real const> const& fcy = fcent[1]->const_array(mfi);
+                Array4<Real const> const& ccc = ccent.const_array(mfi);
+                predict_godunov_on_box_eb(lev, xbx, ybx, a_umac, a_vmac, a_vel, a_f,
+                                          flagfab.const_array(), fcx, fcy, ccc,
+                                          d_bcrec, geom, l_dt);
+                continue;
+            }
+#endif
+
             scratch.resize(bxg1, ncomp*(4*AMREX_SPACEDIM)+AMREX_SPACEDIM);
 //            Elixir eli = scratch.elixir(); // not needed because of streamSynchronize later
             Real* p = scratch.dataPtr();
@@ -283,12 +317,12 @@ void godunov::predict_godunov_on_box (int lev, Box const& bx, int ncomp,
         // Prevent backflow
         if ( (i==dlo.x) and (bc.lo(0) == BCType::foextrap || bc.lo(0) == BCType::hoextrap) )
         {
-            sth = amrex::min(sth,0.);
+            sth = amrex::min(sth,Real(0.));
             stl = sth;
         }
         if ( (i==dhi.x+1) and (bc.hi(0) == BCType::foextrap || bc.hi(0) == BCType::hoextrap) )
         {
-             stl = amrex::max(stl,0.);
+             stl = amrex::max(stl,Real(0.));
              sth = stl;
         }
         Real st = ( (stl+sth) >= 0.) ? stl : sth;
@@ -342,12 +376,12 @@ void godunov::predict_godunov_on_box (int lev, Box const& bx, int ncomp,
         // Prevent backflow
         if ( (j==dlo.y) and (bc.lo(1) == BCType::foextrap || bc.lo(1) == BCType::hoextrap) )
         {
-            sth = amrex::min(sth,0.);
+            sth = amrex::min(sth,Real(0.));
             stl = sth;
         }
         if ( (j==dhi.y+1) and (bc.hi(1) == BCType::foextrap || bc.hi(1) == BCType::hoextrap) )
         {
-            stl = amrex::max(stl,0.);
+            stl = amrex::max(stl,Real(0.));
             sth = stl;
         }
 
@@ -17,6 +17,31 @@ namespace {
         }
         return r;
     }
+
+    // Split the faces of fbx normal to dir into the strips next to ext_dir / hoextrap
+    // domain boundaries, where the slopes of the cells on the boundary need the
+    // one-sided stencils and the face value may be the boundary value, and the
+    // interior faces in between. A box too thin to have interior faces is all strip.
+    void split_face_box (Box const& fbx, int dir, bool lo, bool hi, int domlo, int domhi,
+                         Box& interior, Box& lo_strip, Box& hi_strip)
+    {
+        // Faces domlo, domlo+1 and domhi, domhi+1 see the slope of a boundary cell
+        const int ilo = lo ? amrex::max(fbx.smallEnd(dir), domlo+2) : fbx.smallEnd(dir);
+        const int ihi = hi ? amrex::min(fbx.bigEnd(dir)  , domhi-1) : fbx.bigEnd(dir);
+
+        interior = fbx;
+        lo_strip = fbx;
+        hi_strip = fbx;
+        if (ilo > ihi) {
+            interior = Box();
+            hi_strip = Box();
+            return;
+        }
+        interior.setSmall(dir, ilo);
+        interior.setBig  (dir, ihi);
+        lo_strip.setBig  (dir, ilo-1);
+        hi_strip.setSmall(dir, ihi+1);
+    }
 }
 
 void 
@@ -116,16 +141,26 @@ mol::predict_vels_on_faces (int lev,
     const int domain_khi = domain_box.bigEnd(2);
 #endif
 
-    // At an ext_dir or hoextrap boundary, 
-    //    the boundary value is on the face, not cell center.
+    // The faces are split into interior faces, done with the branch-free slopes,
+    // and strips next to ext_dir or hoextrap boundaries, where the boundary value
+    // is on the face, not cell center.
+    Box interior, lo_strip, hi_strip;
+
     auto extdir_lohi = has_extdir_or_ho(h_bcrec.data(), ncomp, static_cast<int>(Direction::x));
     bool has_extdir_or_ho_lo = extdir_lohi.first;
     bool has_extdir_or_ho_hi = extdir_lohi.second;
 
+    auto u_interior = [vcc,u] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+    {
+        Real upls = vcc(i  ,j,k,0) - 0.5 * incflo_xslope(i  ,j,k,0,vcc);
+        Real umns = vcc(i-1,j,k,0) + 0.5 * incflo_xslope(i-1,j,k,0,vcc);
+        u(i,j,k) = incflo_upwind_face_vel(umns, upls, small_vel);
+    };
+
     if ((has_extdir_or_ho_lo and domain_ilo >= ubx.smallEnd(0)-1) or
         (has_extdir_or_ho_hi and domain_ihi <= ubx.bigEnd(0)))
     {
-        amrex::ParallelFor(ubx, [vcc,domain_ilo,domain_ihi,u,d_bcrec]
+        auto u_strip = [vcc,domain_ilo,domain_ihi,u,d_bcrec]
         AMREX_GPU_DEVICE (int i, int j, int k) noexcept
         {
             bool extdir_or_ho_ilo = (d_bcrec[0].lo(0) == BCType::ext_dir) or
@@ -142,19 +177,7 @@ mol::predict_vels_on_faces (int lev,
             Real umns = vcc_mns + 0.5 * incflo_xslope_extdir
                 (i-1,j,k,0,vcc, extdir_or_ho_ilo, extdir_or_ho_ihi, domain_ilo, domain_ihi);
 
-            Real u_val(0);
-
-            if (umns >= 0.0 or upls <= 0.0) {
-                
-                Real avg = 0.5 * (upls + umns);
-
-                if (avg >= small_vel) {
-                    u_val = umns;
-                }
-                else if (avg <= -small_vel){
-                    u_val = upls;
-                }
-            }
+            Real u_val = incflo_upwind_face_vel(umns, upls, small_vel);
 
             if (i == domain_ilo && (d_bcrec[0].lo(0) == BCType::ext_dir)) {
                 u_val = vcc_mns;
@@ -163,44 +186,34 @@ mol::predict_vels_on_faces (int lev,
             }
 
             u(i,j,k) = u_val;
-        });
+        };
+
+        split_face_box(ubx, 0, has_extdir_or_ho_lo, has_extdir_or_ho_hi, domain_ilo, domain_ihi,
+                       interior, lo_strip, hi_strip);
+        if (interior.ok()) amrex::ParallelFor(interior, u_interior);
+        if (lo_strip.ok()) amrex::ParallelFor(lo_strip, u_strip);
+        if (hi_strip.ok()) amrex::ParallelFor(hi_strip, u_strip);
     }
     else
     {
-        amrex::ParallelFor(ubx, [vcc,u]
-        AMREX_GPU_DEVICE (int i, int j, int k) noexcept
-        {
-            Real upls = vcc(i  ,j,k,0) - 0.5 * incflo_xslope(i  ,j,k,0,vcc);
-            Real umns = vcc(i-1,j,k,0) + 0.5 * incflo_xslope(i-1,j,k,0,vcc);
-
-            Real u_val(0);
-
-            if (umns >= 0.0 or upls <= 0.0) {
-                
-                Real avg = 0.5 * (upls + umns);
-                
-                if (avg >= small_vel) {
-                    u_val = umns;
-                }
-                else if (avg <= -small_vel){
-                    u_val = upls;
-                }
-            }
-
-            u(i,j,k) = u_val;
-        });
+        amrex::ParallelFor(ubx, u_interior);
     }
 
-    // At an ext_dir or hoextrap boundary, 
-    //    the boundary value is on the face, not cell center.
     extdir_lohi = has_extdir_or_ho(h_bcrec.data(), ncomp, static_cast<int>(Direction::y));
     has_extdir_or_ho_lo = extdir_lohi.first;
     has_extdir_or_ho_hi = extdir_lohi.second;
 
+    auto v_interior = [vcc,v] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+    {
+        Real vpls = vcc(i,j  ,k,1) - 0.5 * incflo_yslope(i,j  ,k,1,vcc);
+        Real vmns = vcc(i,j-1,k,1) + 0.5 * incflo_yslope(i,j-1,k,1,vcc);
+        v(i,j,k) = incflo_upwind_face_vel(vmns, vpls, small_vel);
+    };
+
     if ((has_extdir_or_ho_lo and domain_jlo >= vbx.smallEnd(1)-1) or
         (has_extdir_or_ho_hi and domain_jhi <= vbx.bigEnd(1)))
     {
-        amrex::ParallelFor(vbx, [vcc,domain_jlo,domain_jhi,v,d_bcrec]
+        auto v_strip = [vcc,domain_jlo,domain_jhi,v,d_bcrec]
         AMREX_GPU_DEVICE (int i, int j, int k) noexcept
         {
             bool extdir_or_ho_jlo = (d_bcrec[1].lo(1) == BCType::ext_dir) or
@@ -216,18 +229,7 @@ mol::predict_vels_on_faces (int lev,
             Real vmns = vcc_mns + 0.5 * incflo_yslope_extdir
                 (i,j-1,k,1,vcc, extdir_or_ho_jlo, extdir_or_ho_jhi, domain_jlo, domain_jhi);
 
-            Real v_val(0);
-
-            if (vmns >= 0.0 or vpls <= 0.0) {
-                Real avg = 0.5 * (vpls + vmns);
-
-                if (avg >= small_vel) {
-                    v_val = vmns;
-                }
-                else if (avg <= -small_vel){
-                    v_val = vpls;
-                }
-            }
+            Real v_val = incflo_upwind_face_vel(vmns, vpls, small_vel);
 
             if (j == domain_jlo && (d_bcrec[1].lo(1) == BCType::ext_dir)) {
                 v_val = vcc_mns;
@@ -236,44 +238,35 @@ mol::predict_vels_on_faces (int lev,
             }
 
             v(i,j,k) = v_val;
-        });
+        };
+
+        split_face_box(vbx, 1, has_extdir_or_ho_lo, has_extdir_or_ho_hi, domain_jlo, domain_jhi,
+                       interior, lo_strip, hi_strip);
+        if (interior.ok()) amrex::ParallelFor(interior, v_interior);
+        if (lo_strip.ok()) amrex::ParallelFor(lo_strip, v_strip);
+        if (hi_strip.ok()) amrex::ParallelFor(hi_strip, v_strip);
     }
     else
     {
-        amrex::ParallelFor(vbx, [vcc,v]
-        AMREX_GPU_DEVICE (int i, int j, int k) noexcept
-        {
-            Real vpls = vcc(i,j  ,k,1) - 0.5 * incflo_yslope(i,j  ,k,1,vcc);
-            Real vmns = vcc(i,j-1,k,1) + 0.5 * incflo_yslope(i,j-1,k,1,vcc);
-
-            Real v_val(0);
-
-            if (vmns >= 0.0 or vpls <= 0.0) {
-                Real avg = 0.5 * (vpls + vmns);
-
-                if (avg >= small_vel) {
-                    v_val = vmns;
-                }
-                else if (avg <= -small_vel) {
-                    v_val = vpls;
-                }
-            }
-
-            v(i,j,k) = v_val;
-        });
+        amrex::ParallelFor(vbx, v_interior);
     }
 
 #if (AMREX_SPACEDIM == 3)
-    // At an ext_dir or hoextrap boundary, 
-    //    the boundary value is on the face, not cell center.
     extdir_lohi = has_extdir_or_ho(h_bcrec.data(), ncomp, static_cast<int>(Direction::z));
     has_extdir_or_ho_lo = extdir_lohi.first;
     has_extdir_or_ho_hi = extdir_lohi.second;
 
+    auto w_interior = [vcc,w] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+    {
+        Real wpls = vcc(i,j,k  ,2) - 0.5 * incflo_zslope(i,j,k  ,2,vcc);
+        Real wmns = vcc(i,j,k-1,2) + 0.5 * incflo_zslope(i,j,k-1,2,vcc);
+        w(i,j,k) = incflo_upwind_face_vel(wmns, wpls, small_vel);
+    };
+
     if ((has_extdir_or_ho_lo and domain_klo >= wbx.smallEnd(2)-1) or
         (has_extdir_or_ho_hi and domain_khi <= wbx.bigEnd(2)))
     {
-        amrex::ParallelFor(wbx, [vcc,domain_klo,domain_khi,w,d_bcrec]
+        auto w_strip = [vcc,domain_klo,domain_khi,w,d_bcrec]
         AMREX_GPU_DEVICE (int i, int j, int k) noexcept
         {
             bool extdir_or_ho_klo = (d_bcrec[2].lo(2) == BCType::ext_dir) or
@@ -289,18 +282,7 @@ mol::predict_vels_on_faces (int lev,
             Real wmns = vcc_mns + 0.5 * incflo_zslope_extdir(
                 i,j,k-1,2,vcc, extdir_or_ho_klo, extdir_or_ho_khi, domain_klo, domain_khi);
 
-            Real w_val(0);
-
-            if (wmns >= 0.0 or wpls <= 0.0) {
-                Real avg = 0.5 * (wpls + wmns);
-
-                if (avg >= small_vel) {
-                    w_val = wmns;
-                }
-                else if (avg <= -small_vel) {
-                    w_val = wpls;
-                }
-            }
+            Real w_val = incflo_upwind_face_vel(wmns, wpls, small_vel);
 
             if (k == domain_klo && (d_bcrec[2].lo(2) == BCType::ext_dir)) {
                 w_val = vcc_mns;
@@ -309,31 +291,17 @@ mol::predict_vels_on_faces (int lev,
             }
 
             w(i,j,k) = w_val;
-        });
+        };
+
+        split_face_box(wbx, 2, has_extdir_or_ho_lo, has_extdir_or_ho_hi, domain_klo, domain_khi,
+                       interior, lo_strip, hi_strip);
+        if (interior.ok()) amrex::ParallelFor(interior, w_interior);
+        if (lo_strip.ok()) amrex::ParallelFor(lo_strip, w_strip);
+        if (hi_strip.ok()) amrex::ParallelFor(hi_strip, w_strip);
     }
     else
     {
-        amrex::ParallelFor(wbx, [vcc,w]
-        AMREX_GPU_DEVICE (int i, int j, int k) noexcept
-        {
-            Real wpls = vcc(i,j,k  ,2) - 0.5 * incflo_zslope(i,j,k  ,2,vcc);
-            Real wmns = vcc(i,j,k-1,2) + 0.5 * incflo_zslope(i,j,k-1,2,vcc);
-
-            Real w_val(0);
-
-            if (wmns >= 0.0 or wpls <= 0.0) {
-                Real avg = 0.5 * (wpls + wmns);
-
-                if (avg >= small_vel) {
-                    w_val = wmns;
-                }
-                else if (avg <= -small_vel) {
-                    w_val = wpls;
-                }
-            }
-
-            w(i,j,k) = w_val;
-        });
+        amrex::ParallelFor(wbx, w_interior);
     }
 #endif
 }
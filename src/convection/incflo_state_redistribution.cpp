@@ -0,0 +1,231 @@
+#include <incflo.H>
+
+using namespace amrex;
+
+//
+// State redistribution for the cut cells, after Berger & Giuliani. Each small cell
+// (volume fraction below one half) is merged with a few connected neighbours on its
+// fluid side until the merged volume reaches one half. The provisional states
+// U + dt dUdt are averaged over every neighbourhood, and the new state of a cell is the
+// mean of the averages of all the neighbourhoods it belongs to. This is conservative,
+// keeps constant states constant and lets dt follow the regular-cell CFL condition.
+// The neighbourhood averages are piecewise constant, so the update near the EB is
+// first order.
+//
+
+#ifdef AMREX_USE_EB
+namespace {
+
+// Offsets in the 3^SPACEDIM block around a cell are encoded as 0..26, 13 being the cell
+AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE
+int srd_encode (int ii, int jj, int kk) noexcept
+{
+    return (ii+1) + 3*(jj+1) + 9*(kk+1);
+}
+
+AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE
+void srd_decode (int code, int& ii, int& jj, int& kk) noexcept
+{
+    ii = code%3 - 1;
+    jj = (code/3)%3 - 1;
+    kk = code/9 - 1;
+}
+
+constexpr int srd_max_nbr = (1 << AMREX_SPACEDIM) - 1;
+constexpr int srd_kr = (AMREX_SPACEDIM == 3) ? 1 : 0;
+constexpr Real srd_target_vol = 0.5;
+
+}
+
+void incflo::make_state_redistribution_data (int lev)
+{
+    BL_PROFILE("incflo::make_state_redistribution_data()");
+
+    m_srd_itracker.resize(finest_level+1);
+    m_srd_data.resize(finest_level+1);
+
+    auto const& fact = EBFactory(lev);
+    auto const& flags = fact.getMultiEBCellFlagFab();
+    auto const& volfrac = fact.getVolFrac();
+    const Box dbox = Geom(lev).growPeriodicDomain(2);
+
+    // The update of a cell reads the neighbourhoods one cell away, whose averages
+    // read the overlap counts two cells away, which need the neighbours three cells away
+    m_srd_itracker[lev].reset(new iMultiFab(grids[lev], dmap[lev], 1+srd_max_nbr, 3));
+    m_srd_data[lev].reset(new MultiFab(grids[lev], dmap[lev], 2, 2));
+    iMultiFab& itracker_mf = *m_srd_itracker[lev];
+    MultiFab& srd_mf = *m_srd_data[lev];
+
+    // No tiling: the overlap counts and volumes of a fab are computed from the
+    // neighbourhoods of that fab alone
+#ifdef _OPENMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+    for (MFIter mfi(srd_mf); mfi.isValid(); ++mfi)
+    {
+        Box const& bxg3 = amrex::grow(mfi.validbox(),3);
+        Box const& bxg2 = amrex::grow(mfi.validbox(),2);
+        Box const& bxg1 = amrex::grow(mfi.validbox(),1);
+        Array4<int> const& it = itracker_mf.array(mfi);
+        Array4<Real> nrs(srd_mf.array(mfi), 0);
+        Array4<Real> nbhd_vol(srd_mf.array(mfi), 1);
+
+        EBCellFlagFab const& flagfab = flags[mfi];
+        if (flagfab.getType(bxg3) != FabType::singlevalued) {
+            amrex::ParallelFor(bxg3, [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+            {
+                it(i,j,k,0) = 0;
+            });
+            amrex::ParallelFor(bxg2, [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+            {
+                nrs(i,j,k) = 1.0;
+                nbhd_vol(i,j,k) = 1.0;
+            });
+            continue;
+        }
+
+        Array4<EBCellFlag const> const& flag = flagfab.const_array();
+        Array4<Real const> const& vfrac = volfrac.const_array(mfi);
+
+        // Neighbourhoods of the small cells. The fluid side is taken from the gradient
+        // of the volume fraction; the face neighbour across its largest component is
+        // merged first, then the other face, edge and corner neighbours on that side.
+        amrex::ParallelFor(bxg3, [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+        {
+            int nbr = 0;
+            Real vol = vfrac(i,j,k);
+            if (flag(i,j,k).isSingleValued() and vol < srd_target_vol and
+                dbox.contains(IntVect(AMREX_D_DECL(i,j,k))))
+            {
+                GpuArray<Real,AMREX_SPACEDIM> grad;
+                AMREX_D_TERM(grad[0] = vfrac(i+1,j,k) - vfrac(i-1,j,k);,
+                             grad[1] = vfrac(i,j+1,k) - vfrac(i,j-1,k);,
+                             grad[2] = vfrac(i,j,k+1) - vfrac(i,j,k-1););
+                int dmax = 0;
+                GpuArray<int,3> side{{0,0,0}};
+                for (int d = 0; d < AMREX_SPACEDIM; ++d) {
+                    side[d] = (grad[d] >= 0.0) ? 1 : -1;
+                    if (amrex::Math::abs(grad[d]) > amrex::Math::abs(grad[dmax])) dmax = d;
+                }
+
+                for (int pass = 0; pass <= AMREX_SPACEDIM and vol < srd_target_vol; ++pass) {
+                    for (int m = 1; m <= srd_max_nbr and vol < srd_target_vol; ++m) {
+                        const int npc = (m & 1) + ((m >> 1) & 1) + ((m >> 2) & 1);
+                        const bool take = (pass == 0) ? (m == (1 << dmax))
+                                                      : (npc == pass and m != (1 << dmax));
+                        if (!take) continue;
+                        const int ii = (m & 1) ? side[0] : 0;
+                        const int jj = (m & 2) ? side[1] : 0;
+                        const int kk = (m & 4) ? side[2] : 0;
+                        if (flag(i,j,k).isConnected(ii,jj,kk) and
+                            dbox.contains(IntVect(AMREX_D_DECL(i+ii,j+jj,k+kk))))
+                        {
+                            it(i,j,k,1+nbr) = srd_encode(ii,jj,kk);
+                            vol += vfrac(i+ii,j+jj,k+kk);
+                            ++nbr;
+                        }
+                    }
+                }
+            }
+            it(i,j,k,0) = nbr;
+        });
+
+        // Number of neighbourhoods each cell belongs to, its own included
+        amrex::ParallelFor(bxg2, [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+        {
+            int n = 1;
+            for (int kk = -srd_kr; kk <= srd_kr; ++kk) {
+            for (int jj = -1; jj <= 1; ++jj) {
+            for (int ii = -1; ii <= 1; ++ii) {
+                const int code = srd_encode(-ii,-jj,-kk);
+                const int nbr = it(i+ii,j+jj,k+kk,0);
+                for (int m = 1; m <= nbr; ++m) {
+                    if (it(i+ii,j+jj,k+kk,m) == code) ++n;
+                }
+            }}}
+            nrs(i,j,k) = n;
+        });
+
+        // Volume of the neighbourhood of each cell, with every member counted by the
+        // fraction of it that belongs to this neighbourhood
+        amrex::ParallelFor(bxg1, [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+        {
+            Real v = vfrac(i,j,k) / nrs(i,j,k);
+            for (int m = 1; m <= it(i,j,k,0); ++m) {
+                int ii, jj, kk;
+                srd_decode(it(i,j,k,m), ii, jj, kk);
+                v += vfrac(i+ii,j+jj,k+kk) / nrs(i+ii,j+jj,k+kk);
+            }
+            nbhd_vol(i,j,k) = (v > 0.0) ? v : 1.0;
+        });
+    }
+}
+
+void incflo::redistribute_state_eb (Box const& bx, int ncomp,
+                                    Array4<Real> const& dUdt,
+                                    Array4<Real const> const& dUdt_in,
+                                    Array4<Real const> const& U,
+                                    Array4<Real> const& scratch,
+                                    Array4<EBCellFlag const> const& flag,
+                                    Array4<Real const> const& vfrac,
+                                    Array4<int const> const& itracker,
+                                    Array4<Real const> const& srd,
+                                    Real dt)
+{
+    Array4<Real> uhat(scratch, 0);
+    Array4<Real> qhat(scratch, ncomp);
+    Array4<Real const> nrs(srd, 0);
+    Array4<Real const> nbhd_vol(srd, 1);
+
+    Box const& bxg1 = amrex::grow(bx,1);
+    Box const& bxg2 = amrex::grow(bx,2);
+
+    // Provisional states
+    amrex::ParallelFor(bxg2, ncomp,
+    [=] AMREX_GPU_DEVICE (int i, int j, int k, int n) noexcept
+    {
+        uhat(i,j,k,n) = flag(i,j,k).isCovered() ? 0.0 : U(i,j,k,n) + dt*dUdt_in(i,j,k,n);
+    });
+
+    // Neighbourhood averages
+    amrex::ParallelFor(bxg1, ncomp,
+    [=] AMREX_GPU_DEVICE (int i, int j, int k, int n) noexcept
+    {
+        Real q = vfrac(i,j,k) / nrs(i,j,k) * uhat(i,j,k,n);
+        for (int m = 1; m <= itracker(i,j,k,0); ++m) {
+            int ii, jj, kk;
+            srd_decode(itracker(i,j,k,m), ii, jj, kk);
+            q += vfrac(i+ii,j+jj,k+kk) / nrs(i+ii,j+jj,k+kk) * uhat(i+ii,j+jj,k+kk,n);
+        }
+        qhat(i,j,k,n) = q / nbhd_vol(i,j,k);
+    });
+
+    // New state from all the neighbourhoods a cell belongs to
+    const Real dtinv = 1.0/dt;
+    amrex::ParallelFor(bx, ncomp,
+    [=] AMREX_GPU_DEVICE (int i, int j, int k, int n) noexcept
+    {
+        if (flag(i,j,k).isCovered()) {
+            dUdt(i,j,k,n) = dUdt_in(i,j,k,n);
+            return;
+        }
+        if (nrs(i,j,k) == 1.0 and itracker(i,j,k,0) == 0) {
+            dUdt(i,j,k,n) = dUdt_in(i,j,k,n);
+            return;
+        }
+        Real unew = qhat(i,j,k,n);
+        for (int kk = -srd_kr; kk <= srd_kr; ++kk) {
+        for (int jj = -1; jj <= 1; ++jj) {
+        for (int ii = -1; ii <= 1; ++ii) {
+            const int code = srd_encode(-ii,-jj,-kk);
+            for (int m = 1; m <= itracker(i+ii,j+jj,k+kk,0); ++m) {
+                if (itracker(i+ii,j+jj,k+kk,m) == code) {
+                    unew += qhat(i+ii,j+jj,k+kk,n);
+                }
+            }
+        }}}
+        unew /= nrs(i,j,k);
+        dUdt(i,j,k,n) = (unew - U(i,j,k,n)) * dtinv;
+    });
+}
+#endif
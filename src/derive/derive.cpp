@@ -6,39 +6,51 @@
 
 using namespace amrex;
 
-void incflo::ComputeDivU(Real time_in)
+//
+// Cell-centered div(u) of the current velocity, averaged from the nodal divergence
+// that the nodal projection drives to zero. The MLNodeLaplacian, and with EB its
+// cut-cell integrals, is built on first use and kept until the next regrid.
+//
+void incflo::ComputeDivU (Vector<MultiFab*> const& divu, Real time)
 {
-#if 0
+    BL_PROFILE("incflo::ComputeDivU");
 
-    incflo_set_velocity_bcs(time_in, vel);
-
-    int bc_lo[3], bc_hi[3];
-    Box domain(geom[0].Domain());
-
-    set_ppe_bcs(bc_lo, bc_hi,
-                domain.loVect(), domain.hiVect(),
-                &nghost,
-                bc_ilo[0]->dataPtr(), bc_ihi[0]->dataPtr(),
-                bc_jlo[0]->dataPtr(), bc_jhi[0]->dataPtr(),
-                bc_klo[0]->dataPtr(), bc_khi[0]->dataPtr());
-
-    ppe_lobc = {(LinOpBCType)bc_lo[0], (LinOpBCType)bc_lo[1], (LinOpBCType)bc_lo[2]};
-    ppe_hibc = {(LinOpBCType)bc_hi[0], (LinOpBCType)bc_hi[1], (LinOpBCType)bc_hi[2]};
+    if (!m_divu_linop)
+    {
+        LPInfo info;
+        info.setMaxCoarseningLevel(0);
+#ifdef AMREX_USE_EB
+        Vector<EBFArrayBoxFactory const*> ebfact;
+        for (int lev = 0; lev <= finest_level; ++lev) {
+            ebfact.push_back(&(EBFactory(lev)));
+        }
+        m_divu_linop.reset(new MLNodeLaplacian(Geom(0,finest_level), boxArray(0,finest_level),
+                                               DistributionMap(0,finest_level), info, ebfact));
+#else
+        m_divu_linop.reset(new MLNodeLaplacian(Geom(0,finest_level), boxArray(0,finest_level),
+                                               DistributionMap(0,finest_level), info));
+#endif
+        m_divu_linop->setDomainBC(get_projection_bc(Orientation::low),
+                                  get_projection_bc(Orientation::high));
+    }
 
-    LPInfo lpinfo;
+    // Work on a copy so that the ghost cells of the state are left alone
+    Vector<MultiFab> vel(finest_level+1);
+    Vector<MultiFab> divu_nd(finest_level+1);
+    for (int lev = 0; lev <= finest_level; ++lev) {
+        vel[lev].define(grids[lev], dmap[lev], AMREX_SPACEDIM, 1, MFInfo(), Factory(lev));
+        fillpatch_velocity(lev, time, vel[lev], 1);
+        divu_nd[lev].define(amrex::convert(grids[lev],IntVect::TheNodeVector()), dmap[lev], 1, 0);
+    }
 
-    //
-    // This rebuilds integrals each time linop is created -- must find a better way
-    //
+    m_divu_linop->compDivergence(GetVecOfPtrs(divu_nd), GetVecOfPtrs(vel));
 
+    for (int lev = 0; lev <= finest_level; ++lev) {
+        amrex::average_node_to_cellcenter(*divu[lev], 0, divu_nd[lev], 0, 1);
 #ifdef AMREX_USE_EB
-    MLNodeLaplacian linop(geom, grids, dmap, lpinfo, GetVecOfConstPtrs(ebfactory));
-#else
-    MLNodeLaplacian linop(geom, grids, dmap, lpinfo);
-#endif
-    linop.setDomainBC(ppe_lobc,ppe_hibc);
-    linop.compDivergence(GetVecOfPtrs(divu),GetVecOfPtrs(vel));
+        EB_set_covered(*divu[lev], 0.0);
 #endif
+    }
 }
 
 void incflo::compute_strainrate_at_level (int lev,
@@ -94,49 +106,151 @@ void incflo::compute_strainrate_at_level (int lev,
         }
 }
 
-Real incflo::ComputeKineticEnergy () const
+//
+// Volume integrals over the part of each level not covered by a finer one:
+//
+//   [0]      0.5 int rho |u|^2 dV      (kinetic energy)
+//   [1]      int rho dV                (mass)
+//   [2]      0.5 int |omega|^2 dV      (enstrophy)
+//   [3+n]    int rho s_n dV            (tracer content)
+//
+// All levels are covered by one pass over the data and the result is reduced with
+// a single MPI call, so this is cheap enough to call every step. The sums are kept
+// in double, also in single-precision builds, and are identical on all ranks.
+//
+Vector<double> incflo::ComputeIntegrals (Real time)
 {
-#if 0
-    BL_PROFILE("incflo::ComputeKineticEnergy");
+    BL_PROFILE("incflo::ComputeIntegrals");
+
+    const int ntrac = m_ntrac;
+    Vector<iMultiFab> const& masks = diag_masks();
+
+    ReduceOps<ReduceOpSum,ReduceOpSum,ReduceOpSum> reduce_op;
+    ReduceData<double,double,double> reduce_data(reduce_op);
+    using ReduceTuple = typename decltype(reduce_data)::Type;
 
-    // integrated total Kinetic energy
-    Real KE = 0.0;
+    ReduceOps<ReduceOpSum> trac_op;
+    Vector<std::unique_ptr<ReduceData<double> > > trac_data(ntrac);
+    for (auto& td : trac_data) td.reset(new ReduceData<double>(trac_op));
+    using TracTuple = typename ReduceData<double>::Type;
 
-    for(int lev = 0; lev <= finest_level; lev++)
+    for (int lev = 0; lev <= finest_level; ++lev)
     {
-        Real cell_vol = geom[lev].CellSize()[0]*geom[lev].CellSize()[1]*geom[lev].CellSize()[2];
+        auto& ld = *m_leveldata[lev];
+
+        // The vorticity needs one layer of ghost cells; fill them in a copy so
+        // that the ghost cells of the state are left alone
+        MultiFab velocity(grids[lev], dmap[lev], AMREX_SPACEDIM, 1, MFInfo(), Factory(lev));
+        fillpatch_velocity(lev, time, velocity, 1);
+
+        const double dv = AMREX_D_TERM(geom[lev].CellSize(0),*geom[lev].CellSize(1),*geom[lev].CellSize(2));
+        const auto dxinv = geom[lev].InvCellSizeArray();
+
+#ifdef AMREX_USE_EB
+        auto const& factory = EBFactory(lev);
+        auto const& flags = factory.getMultiEBCellFlagFab();
+#endif
 
-        KE += amrex::ReduceSum(*density[lev],*vel[lev],*level_mask[lev],0,
-        [=] AMREX_GPU_HOST_DEVICE (Box const& bx,
-                                   Array4<Real const> const& den_arr,
-                                   Array4<Real const> const& vel_arr,
-                                   Array4<int const>  const& mask_arr) -> Real
+        for (MFIter mfi(ld.density,TilingIfNotGPU()); mfi.isValid(); ++mfi)
         {
-            Real KE_Fab = 0.0;
+            Box const& bx = mfi.tilebox();
+            Array4<Real const> const& rho = ld.density.const_array(mfi);
+            Array4<Real const> const& vel = velocity.const_array(mfi);
+            Array4<Real const> const& tra = (ntrac > 0) ? ld.tracer.const_array(mfi)
+                                                        : Array4<Real const>{};
+            Array4<int const> const& msk = masks[lev].const_array(mfi);
+#ifdef AMREX_USE_EB
+            if (flags[mfi].getType(bx) == FabType::covered) continue;
+            Array4<EBCellFlag const> const& flag = flags[mfi].const_array();
+            Array4<Real const> const& vfrac = factory.getVolFrac().const_array(mfi);
+#endif
 
-            amrex::Loop(bx, [=,&KE_Fab] (int i, int j, int k) noexcept
+            reduce_op.eval(bx, reduce_data,
+            [=] AMREX_GPU_DEVICE (int i, int j, int k) -> ReduceTuple
             {
-                KE_Fab += cell_vol*mask_arr(i,j,k)*den_arr(i,j,k)*( vel_arr(i,j,k,0)*vel_arr(i,j,k,0)
-                                                                   +vel_arr(i,j,k,1)*vel_arr(i,j,k,1)
-                                                                   +vel_arr(i,j,k,2)*vel_arr(i,j,k,2));
+                GpuArray<bool,2*AMREX_SPACEDIM> conn;
+#ifdef AMREX_USE_EB
+                const EBCellFlag fl = flag(i,j,k);
+                const double w = msk(i,j,k) * vfrac(i,j,k) * dv;
+                AMREX_D_TERM(conn[0] = fl.isConnected(-1,0,0); conn[1] = fl.isConnected(1,0,0);,
+                             conn[2] = fl.isConnected(0,-1,0); conn[3] = fl.isConnected(0,1,0);,
+                             conn[4] = fl.isConnected(0,0,-1); conn[5] = fl.isConnected(0,0,1););
+#else
+                const double w = msk(i,j,k) * dv;
+                for (auto& c : conn) c = true;
+#endif
+                if (w == 0.0) return { 0.0, 0.0, 0.0 };
+
+                double u2 = 0.0;
+                for (int a = 0; a < AMREX_SPACEDIM; ++a) {
+                    u2 += vel(i,j,k,a)*vel(i,j,k,a);
+                }
+
+                Real g[AMREX_SPACEDIM][AMREX_SPACEDIM];
+                incflo_velocity_gradient(i,j,k,vel,dxinv,conn,g);
+#if (AMREX_SPACEDIM == 3)
+                const double w2 = (g[2][1]-g[1][2])*(g[2][1]-g[1][2])
+                    +             (g[0][2]-g[2][0])*(g[0][2]-g[2][0])
+                    +             (g[1][0]-g[0][1])*(g[1][0]-g[0][1]);
+#else
+                const double w2 = (g[1][0]-g[0][1])*(g[1][0]-g[0][1]);
+#endif
 
+                return { 0.5*w*rho(i,j,k)*u2, w*rho(i,j,k), 0.5*w*w2 };
             });
-            return KE_Fab;
 
-        });
+            for (int n = 0; n < ntrac; ++n) {
+                trac_op.eval(bx, *trac_data[n],
+                [=] AMREX_GPU_DEVICE (int i, int j, int k) -> TracTuple
+                {
+#ifdef AMREX_USE_EB
+                    const double w = msk(i,j,k) * vfrac(i,j,k) * dv;
+#else
+                    const double w = msk(i,j,k) * dv;
+#endif
+                    return { w*rho(i,j,k)*tra(i,j,k,n) };
+                });
+            }
+        }
     }
 
-    // total volume of grid on level 0
-    Real total_vol = geom[0].ProbDomain().volume();
-
-    KE *= 0.5/total_vol/ro_0;
+    Vector<double> integrals(3+ntrac);
+    auto hv = reduce_data.value();
+    integrals[0] = amrex::get<0>(hv);
+    integrals[1] = amrex::get<1>(hv);
+    integrals[2] = amrex::get<2>(hv);
+    for (int n = 0; n < ntrac; ++n) {
+        integrals[3+n] = amrex::get<0>(trac_data[n]->value());
+    }
 
-    ParallelDescriptor::ReduceRealSum(KE);
+    ParallelAllReduce::Sum(integrals.data(), integrals.size(), ParallelContext::CommunicatorSub());
 
-    return KE;
+    return integrals;
+}
 
-#endif
-    return 0;
+//
+// Print the integrals; a non-finite value means the solution has blown up and
+// there is no point in going on.
+//
+void incflo::PrintIntegrals (Real time)
+{
+    Vector<double> integrals = ComputeIntegrals(time);
+
+    // Kinetic energy per unit volume, scaled by the reference density
+    const double total_vol = geom[0].ProbDomain().volume();
+    amrex::Print() << "Time, Kinetic Energy: " << time << ", "
+                   << integrals[0]/(total_vol*m_ro_0) << std::endl;
+    amrex::Print() << "Time, Mass, Enstrophy";
+    for (int n = 0; n < m_ntrac; ++n) amrex::Print() << ", Tracer" << n;
+    amrex::Print() << ": " << time;
+    for (int i = 1; i < integrals.size(); ++i) amrex::Print() << ", " << integrals[i];
+    amrex::Print() << std::endl;
+
+    for (auto v : integrals) {
+        if (!std::isfinite(v)) {
+            amrex::Abort("incflo: non-finite volume integral at step " + std::to_string(m_nstep));
+        }
+    }
 }
 
 #if (AMREX_SPACEDIM == 2)
@@ -390,125 +504,197 @@ void incflo::ComputeVorticity (int lev, Real t, MultiFab& vort, MultiFab const&
 }
 #endif
 
-void incflo::ComputeDrag()
-{
-#if 0
-	BL_PROFILE("incflo::ComputeDrag");
+#ifdef AMREX_USE_EB
+namespace {
 
-    // Coefficients for one-sided difference estimation
-    Real c0 = -1.5;
-    Real c1 = 2.0;
-    Real c2 = -0.5;
+// Velocity gradient g[a][b] = d u_a / d x_b in a cut cell, using second-order
+// one-sided differences next to neighbours that are not connected
+AMREX_GPU_DEVICE AMREX_FORCE_INLINE
+void eb_velocity_gradient (int i, int j, int k, Array4<Real const> const& vel, Real dxinv,
+                           EBCellFlag flag, Real g[AMREX_SPACEDIM][AMREX_SPACEDIM]) noexcept
+{
+    constexpr Real c0 = -1.5;
+    constexpr Real c1 =  2.0;
+    constexpr Real c2 = -0.5;
 
-    for(int lev = 0; lev <= finest_level; lev++)
+    for (int b = 0; b < AMREX_SPACEDIM; ++b)
     {
-        Box domain(geom[lev].Domain());
-        Real dx = geom[lev].CellSize()[0];
+        const int di = (b == 0), dj = (b == 1), dk = (b == 2);
+        const bool cp = flag.isConnected( di, dj, dk);
+        const bool cm = flag.isConnected(-di,-dj,-dk);
+        for (int a = 0; a < AMREX_SPACEDIM; ++a)
+        {
+            const Real v0 = vel(i,j,k,a);
+            if (cp and cm) {
+                g[a][b] = Real(0.5) * (vel(i+di,j+dj,k+dk,a) - vel(i-di,j-dj,k-dk,a)) * dxinv;
+            } else if (cm) {
+                // Covered cell on the high side, go fish low
+                g[a][b] = - (c0 * v0 + c1 * vel(i-di,j-dj,k-dk,a) + c2 * vel(i-2*di,j-2*dj,k-2*dk,a)) * dxinv;
+            } else if (cp) {
+                // Covered cell on the low side, go fish high
+                g[a][b] =   (c0 * v0 + c1 * vel(i+di,j+dj,k+dk,a) + c2 * vel(i+2*di,j+2*dj,k+2*dk,a)) * dxinv;
+            } else {
+                g[a][b] = 0.0;
+            }
+        }
+    }
+}
+
+}
+#endif
+
+//
+// Force and torque exerted by the fluid on the embedded boundary,
+//
+//   F = sum over cut cells of ( p n - eta (grad u + grad u^T) n ) A
+//
+// where n is the EB normal (pointing out of the fluid) and A the EB face area, and
+// the torque is taken about diag.torque_center with the lever arm to the EB face
+// centroid. The result holds (Fx, Fy, Fz, Tx, Ty, Tz) and is identical on all ranks.
+//
+// Only the cut cells that are not covered by a finer level are visited; their list
+// is built once per regrid, so the cost is proportional to the size of the surface.
+//
+Vector<double> incflo::ComputeEBForces (Real time)
+{
+    BL_PROFILE("incflo::ComputeEBForces");
 
-        drag[lev]->setVal(0.0);
+    Vector<double> forces(6, 0.0);
 
 #ifdef AMREX_USE_EB
-        // Get EB geometric info
-        const amrex::MultiCutFab* bndryarea;
-        const amrex::MultiCutFab* bndrynorm;
-        bndryarea = &(ebfactory[lev]->getBndryArea());
-        bndrynorm = &(ebfactory[lev]->getBndryNormal());
+    if (m_eb_cut_cells.size() != finest_level+1)
+    {
+        Vector<iMultiFab> const& masks = diag_masks();
+        m_eb_cut_cells.resize(finest_level+1);
+        for (int lev = 0; lev <= finest_level; ++lev)
+        {
+            auto const& flags = EBFactory(lev).getMultiEBCellFlagFab();
+            m_eb_cut_cells[lev].reset(new LayoutData<Gpu::DeviceVector<IntVect> >(grids[lev], dmap[lev]));
+            for (MFIter mfi(flags); mfi.isValid(); ++mfi)
+            {
+                Box const& bx = mfi.validbox();
+                if (flags[mfi].getType(bx) != FabType::singlevalued) continue;
+
+                Array4<EBCellFlag const> const& flag = flags[mfi].const_array();
+                Array4<int const> const& msk = masks[lev].const_array(mfi);
+                Gpu::HostVector<IntVect> cells;
+                amrex::LoopOnCpu(bx, [&] (int i, int j, int k) noexcept
+                {
+                    if (flag(i,j,k).isSingleValued() and msk(i,j,k)) {
+                        cells.push_back(IntVect(AMREX_D_DECL(i,j,k)));
+                    }
+                });
+
+                auto& dcells = (*m_eb_cut_cells[lev])[mfi];
+                dcells.resize(cells.size());
+                Gpu::copy(Gpu::hostToDevice, cells.begin(), cells.end(), dcells.begin());
+            }
+        }
+    }
+
+    // The one-sided differences need two layers of ghost cells
+    Vector<MultiFab> vel(finest_level+1), eta(finest_level+1);
+    for (int lev = 0; lev <= finest_level; ++lev) {
+        vel[lev].define(grids[lev], dmap[lev], AMREX_SPACEDIM, 2, MFInfo(), Factory(lev));
+        eta[lev].define(grids[lev], dmap[lev], 1, 0, MFInfo(), Factory(lev));
+        fillpatch_velocity(lev, time, vel[lev], 2);
+    }
+    compute_viscosity(GetVecOfPtrs(eta), get_density_new(), GetVecOfPtrs(vel), time, 0);
+
+    GpuArray<Real,3> xc{0.0, 0.0, 0.0};
+    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+        xc[idim] = m_diag_torque_center[idim];
+    }
+
+    ReduceOps<ReduceOpSum,ReduceOpSum,ReduceOpSum,ReduceOpSum,ReduceOpSum,ReduceOpSum> reduce_op;
+    ReduceData<double,double,double,double,double,double> reduce_data(reduce_op);
+    using ReduceTuple = typename decltype(reduce_data)::Type;
+
+    for (int lev = 0; lev <= finest_level; ++lev)
+    {
+        const Real dx = geom[lev].CellSize(0);
+        const Real dxinv = geom[lev].InvCellSize(0);
+        const auto problo = geom[lev].ProbLoArray();
+        // The EB face area is stored as a fraction of dx^(SPACEDIM-1)
+        const Real da = AMREX_D_TERM(Real(1.0), *dx, *dx);
+
+        auto const& factory = EBFactory(lev);
+        auto const& flags = factory.getMultiEBCellFlagFab();
+        auto const& bndryarea = factory.getBndryArea();
+        auto const& bndrynorm = factory.getBndryNormal();
+        auto const& bndrycent = factory.getBndryCent();
 
 #ifdef _OPENMP
-#pragma omp parallel for reduction(+:drag) if (Gpu::notInLaunchRegion())
+#pragma omp parallel if (Gpu::notInLaunchRegion())
 #endif
-        for(MFIter mfi(*vel[lev], TilingIfNotGPU()); mfi.isValid(); ++mfi)
+        for (MFIter mfi(vel[lev]); mfi.isValid(); ++mfi)
         {
-            // Tilebox
-            Box bx = mfi.tilebox();
+            auto const& cells = (*m_eb_cut_cells[lev])[mfi];
+            const int ncells = cells.size();
+            if (ncells == 0) continue;
+
+            IntVect const* cell = cells.data();
+            Array4<Real const> const& u = vel[lev].const_array(mfi);
+            Array4<Real const> const& mu = eta[lev].const_array(mfi);
+            Array4<Real const> const& p = m_leveldata[lev]->p.const_array(mfi);
+            Array4<EBCellFlag const> const& flag = flags[mfi].const_array();
+            Array4<Real const> const& area = bndryarea.const_array(mfi);
+            Array4<Real const> const& norm = bndrynorm.const_array(mfi);
+            Array4<Real const> const& bcent = bndrycent.const_array(mfi);
+
+            reduce_op.eval(Box(IntVect(0), IntVect(AMREX_D_DECL(ncells-1,0,0))), reduce_data,
+            [=] AMREX_GPU_DEVICE (int m, int, int) -> ReduceTuple
+            {
+                const IntVect iv = cell[m];
+                const int i = iv[0];
+                const int j = iv[1];
+#if (AMREX_SPACEDIM == 3)
+                const int k = iv[2];
+#else
+                const int k = 0;
+#endif
 
-            // This is to check efficiently if this tile contains any eb stuff
-            const EBFArrayBox& vel_fab = static_cast<EBFArrayBox const&>((*vel[lev])[mfi]);
-            const EBCellFlagFab& flags = vel_fab.getEBCellFlagFab();
+                // The pressure lives on the nodes
+#if (AMREX_SPACEDIM == 3)
+                const Real pc = 0.125 * (p(i,j  ,k  ) + p(i+1,j  ,k  ) + p(i,j+1,k  ) + p(i+1,j+1,k  ) +
+                                         p(i,j  ,k+1) + p(i+1,j  ,k+1) + p(i,j+1,k+1) + p(i+1,j+1,k+1));
+#else
+                const Real pc = 0.25 * (p(i,j,k) + p(i+1,j,k) + p(i,j+1,k) + p(i+1,j+1,k));
+#endif
 
-            if (flags.getType(bx) == FabType::singlevalued)
-            {
-                const auto& drag_arr = drag[lev]->array(mfi);
-                const auto& vel_arr = vel[lev]->array(mfi);
-                const auto& eta_arr = eta[lev]->array(mfi);
-                const auto& p_arr = p[lev]->array(mfi);
-                const auto& bndryarea_arr = bndryarea->array(mfi);
-                const auto& bndrynorm_arr = bndrynorm->array(mfi);
-                const auto& flag_fab = flags.array();
-
-                for(int i = bx.smallEnd(0); i <= bx.bigEnd(0); i++)
-                for(int j = bx.smallEnd(1); j <= bx.bigEnd(1); j++)
-                for(int k = bx.smallEnd(2); k <= bx.bigEnd(2); k++)
-                {
-                    if(flag_fab(i,j,k).isSingleValued())
-                    {
-                        Real area = bndryarea_arr(i,j,k);
-                        Real nx = bndrynorm_arr(i,j,k,0);
-                        Real ny = bndrynorm_arr(i,j,k,1);
-                        Real nz = bndrynorm_arr(i,j,k,2);
-
-                        Real uz, vz, wx, wy, wz;
-
-                        if (!flag_fab(i,j,k).isConnected(0,0, 1))
-                        {
-                            uz = - (c0 * vel_arr(i,j,k,0) + c1 * vel_arr(i,j,k-1,0) + c2 * vel_arr(i,j,k-2,0)) / dx;
-                            vz = - (c0 * vel_arr(i,j,k,1) + c1 * vel_arr(i,j,k-1,1) + c2 * vel_arr(i,j,k-2,1)) / dx;
-                            wz = - (c0 * vel_arr(i,j,k,2) + c1 * vel_arr(i,j,k-1,2) + c2 * vel_arr(i,j,k-2,2)) / dx;
-                        }
-                        else if (!flag_fab(i,j,k).isConnected(0,0,-1))
-                        {
-                            uz = (c0 * vel_arr(i,j,k,0) + c1 * vel_arr(i,j,k+1,0) + c2 * vel_arr(i,j,k+2,0)) / dx;
-                            vz = (c0 * vel_arr(i,j,k,1) + c1 * vel_arr(i,j,k+1,1) + c2 * vel_arr(i,j,k+2,1)) / dx;
-                            wz = (c0 * vel_arr(i,j,k,2) + c1 * vel_arr(i,j,k+1,2) + c2 * vel_arr(i,j,k+2,2)) / dx;
-                        }
-                        else
-                        {
-                            uz = 0.5 * (vel_arr(i,j,k+1,0) - vel_arr(i,j,k-1,0)) / dx;
-                            vz = 0.5 * (vel_arr(i,j,k+1,1) - vel_arr(i,j,k-1,1)) / dx;
-                            wz = 0.5 * (vel_arr(i,j,k+1,2) - vel_arr(i,j,k-1,2)) / dx;
-                        }
-
-                        if (!flag_fab(i,j,k).isConnected(0, 1,0))
-                        {
-                            wy = - (c0 * vel_arr(i,j,k,2) + c1 * vel_arr(i,j-1,k,2) + c2 * vel_arr(i,j-2,k,2)) / dx;
-                        }
-                        else if (!flag_fab(i,j,k).isConnected(0,-1,0))
-                        {
-                            wy = (c0 * vel_arr(i,j,k,2) + c1 * vel_arr(i,j+1,k,2) + c2 * vel_arr(i,j+2,k,2)) / dx;
-                        }
-                        else
-                        {
-                            wy = 0.5 * (vel_arr(i,j+1,k,2) - vel_arr(i,j-1,k,2)) / dx;
-                        }
-
-                        if (!flag_fab(i,j,k).isConnected( 1,0,0))
-                        {
-                            wx = - (c0 * vel_arr(i,j,k,2) + c1 * vel_arr(i-1,j,k,2) + c2 * vel_arr(i-2,j,k,2)) / dx;
-                        }
-                        else if (!flag_fab(i,j,k).isConnected(-1,0,0))
-                        {
-                            wx = (c0 * vel_arr(i,j,k,2) + c1 * vel_arr(i+1,j,k,2) + c2 * vel_arr(i+2,j,k,2)) / dx;
-                        }
-                        else
-                        {
-                            wx = 0.5 * (vel_arr(i+1,j,k,2) - vel_arr(i-1,j,k,2)) / dx;
-                        }
-
-                        Real p_contrib = p_arr(i,j,k) * nz;
-                        Real tau_contrib = - eta_arr(i,j,k) * ( (uz + wx) * nx + (vz + wy) * ny + (wz + wz) * nz );
-
-                        // TODO: Get values on EB centroid,
-                        //       not the default CC and nodal values
-                        drag_arr(i,j,k) = (p_contrib + tau_contrib) * area * dx * dx;
-                    }
-                    else
-                    {
-                        drag_arr(i,j,k) = 0.0;
+                Real g[AMREX_SPACEDIM][AMREX_SPACEDIM];
+                eb_velocity_gradient(i,j,k,u,dxinv,flag(i,j,k),g);
+
+                const Real a = area(i,j,k) * da;
+                double f[3] = {0.0, 0.0, 0.0};
+                double r[3] = {0.0, 0.0, 0.0};
+                for (int d = 0; d < AMREX_SPACEDIM; ++d) {
+                    Real t = pc * norm(i,j,k,d);
+                    for (int e = 0; e < AMREX_SPACEDIM; ++e) {
+                        t -= mu(i,j,k) * (g[d][e] + g[e][d]) * norm(i,j,k,e);
                     }
+                    f[d] = t * a;
+                    r[d] = problo[d] + (iv[d] + 0.5 + bcent(i,j,k,d)) * dx - xc[d];
                 }
-            }
-        } // MFIter
-#endif
+
+                return { f[0], f[1], f[2],
+                         r[1]*f[2] - r[2]*f[1],
+                         r[2]*f[0] - r[0]*f[2],
+                         r[0]*f[1] - r[1]*f[0] };
+            });
+        }
     }
+
+    auto hv = reduce_data.value();
+    forces[0] = amrex::get<0>(hv);
+    forces[1] = amrex::get<1>(hv);
+    forces[2] = amrex::get<2>(hv);
+    forces[3] = amrex::get<3>(hv);
+    forces[4] = amrex::get<4>(hv);
+    forces[5] = amrex::get<5>(hv);
+
+    ParallelAllReduce::Sum(forces.data(), forces.size(), ParallelContext::CommunicatorSub());
 #endif
+
+    return forces;
 }
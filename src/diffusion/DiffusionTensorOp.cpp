@@ -8,6 +8,34 @@
 
 using namespace amrex;
 
+namespace {
+
+// Largest relative change max |a - b| / |b| of component 0 over the valid cells
+Real max_rel_change (MultiFab const& a, MultiFab const& b)
+{
+    ReduceOps<ReduceOpMax> reduce_op;
+    ReduceData<Real> reduce_data(reduce_op);
+    using ReduceTuple = typename decltype(reduce_data)::Type;
+
+    for (MFIter mfi(b,TilingIfNotGPU()); mfi.isValid(); ++mfi)
+    {
+        Box const& bx = mfi.tilebox();
+        Array4<Real const> const& aa = a.const_array(mfi);
+        Array4<Real const> const& ba = b.const_array(mfi);
+        reduce_op.eval(bx, reduce_data,
+        [=] AMREX_GPU_DEVICE (int i, int j, int k) -> ReduceTuple
+        {
+            const Real d = amrex::Math::abs(aa(i,j,k) - ba(i,j,k));
+            const Real s = amrex::Math::abs(ba(i,j,k));
+            return { (s > Real(0.0)) ? d/s : d };
+        });
+    }
+
+    return amrex::get<0>(reduce_data.value());
+}
+
+}
+
 DiffusionTensorOp::DiffusionTensorOp (incflo* a_incflo)
     : m_incflo(a_incflo)
 {
@@ -38,7 +66,7 @@ DiffusionTensorOp::DiffusionTensorOp (incflo* a_incflo)
                                        m_incflo->get_diffuse_tensor_bc(Orientation::high));
         }
 
-        if (m_incflo->need_divtau() || m_incflo->useTensorCorrection()) 
+        if (m_incflo->need_divtau() || m_incflo->useTensorCorrection() || m_lagged_tol > 0.0)
         {
             m_eb_apply_op.reset(new MLEBTensorOp(m_incflo->Geom(0,finest_level),
                                                  m_incflo->boxArray(0,finest_level),
@@ -63,7 +91,7 @@ DiffusionTensorOp::DiffusionTensorOp (incflo* a_incflo)
                                         m_incflo->get_diffuse_tensor_bc(Orientation::high));
         }
 
-        if (m_incflo->need_divtau() || m_incflo->useTensorCorrection()) 
+        if (m_incflo->need_divtau() || m_incflo->useTensorCorrection() || m_lagged_tol > 0.0)
         {
             m_reg_apply_op.reset(new MLTensorOp(m_incflo->Geom(0,finest_level),
                                                 m_incflo->boxArray(0,finest_level),
@@ -95,28 +123,47 @@ DiffusionTensorOp::readParameters ()
 
     pp.query("num_pre_smooth", m_num_pre_smooth);
     pp.query("num_post_smooth", m_num_post_smooth);
+
+    pp.query("lagged_tol", m_lagged_tol);
+    pp.query("lagged_inner_rtol", m_lagged_inner_rtol);
+    pp.query("lagged_max_iter", m_lagged_max_iter);
+    pp.query("lagged_outer_rtol", m_lagged_outer_rtol);
 }
 
 void
-DiffusionTensorOp::diffuse_velocity (Vector<MultiFab*> const& velocity,
-                                     Vector<MultiFab*> const& density,
-                                     Vector<MultiFab const*> const& eta,
-                                     Real dt)
+DiffusionTensorOp::setup_solver (MLMG& mlmg) const
 {
-    //
-    //      alpha a - beta div ( b grad )   <--->   rho - dt div ( mu grad )
-    //
-    // So the constants and variable coefficients are:
-    //
-    //      alpha: 1
-    //      beta: dt
-    //      a: rho
-    //      b: mu
-
-    if (m_verbose > 0) {
-        amrex::Print() << "Diffusing velocity components all together..." << std::endl;
+    // The default bottom solver is BiCG
+    if (m_bottom_solver == "smoother")
+    {
+        mlmg.setBottomSolver(MLMG::BottomSolver::smoother);
+    }
+    else if (m_bottom_solver == "hypre")
+    {
+        mlmg.setBottomSolver(MLMG::BottomSolver::hypre);
     }
+    // Maximum iterations for MultiGrid / ConjugateGradients
+    mlmg.setMaxIter(m_mg_max_iter);
+    mlmg.setMaxFmgIter(m_mg_max_fmg_iter);
+    mlmg.setCGMaxIter(m_mg_cg_maxiter);
 
+    // Verbosity for MultiGrid / ConjugateGradients
+    mlmg.setVerbose(m_mg_verbose);
+    mlmg.setCGVerbose(m_mg_cg_verbose);
+
+    mlmg.setPreSmooth(m_num_pre_smooth);
+    mlmg.setPostSmooth(m_num_post_smooth);
+}
+
+//
+// (Re)build the coefficients of the solve operator. With lagging enabled the
+// coefficients are remembered so that later steps can tell how stale they are.
+//
+void
+DiffusionTensorOp::set_solve_coeffs (Vector<MultiFab*> const& density,
+                                     Vector<MultiFab const*> const& eta,
+                                     Real dt)
+{
     const int finest_level = m_incflo->finestLevel();
 
 #ifdef AMREX_USE_EB
@@ -147,6 +194,199 @@ DiffusionTensorOp::diffuse_velocity (Vector<MultiFab*> const& velocity,
         }
     }
 
+    if (m_lagged_tol > 0.0)
+    {
+        m_frozen_rho.resize(finest_level+1);
+        m_frozen_eta.resize(finest_level+1);
+        for (int lev = 0; lev <= finest_level; ++lev) {
+            m_frozen_rho[lev].define(density[lev]->boxArray(), density[lev]->DistributionMap(), 1, 0);
+            m_frozen_eta[lev].define(eta[lev]->boxArray(), eta[lev]->DistributionMap(), 1, 0);
+            MultiFab::Copy(m_frozen_rho[lev], *density[lev], 0, 0, 1, 0);
+            MultiFab::Copy(m_frozen_eta[lev], *eta[lev], 0, 0, 1, 0);
+        }
+        m_frozen_dt = dt;
+    }
+}
+
+// Can the solve operator built with the frozen coefficients still be used?
+bool
+DiffusionTensorOp::frozen_coeffs_ok (Vector<MultiFab*> const& density,
+                                     Vector<MultiFab const*> const& eta,
+                                     Real dt) const
+{
+    const int finest_level = m_incflo->finestLevel();
+    if (m_frozen_eta.size() != finest_level+1) return false;
+
+    Real change = amrex::Math::abs(dt - m_frozen_dt) / m_frozen_dt;
+    for (int lev = 0; lev <= finest_level; ++lev) {
+        change = amrex::max(change, max_rel_change(*density[lev], m_frozen_rho[lev]));
+        change = amrex::max(change, max_rel_change(*eta[lev], m_frozen_eta[lev]));
+    }
+    ParallelAllReduce::Max(change, ParallelContext::CommunicatorSub());
+
+    if (m_verbose > 0) {
+        amrex::Print() << "  Relative change of the lagged diffusion coefficients: "
+                       << change << std::endl;
+    }
+
+    return change <= m_lagged_tol;
+}
+
+//
+// Solve A(rho, eta, dt) u = rhs with the solve operator still holding the frozen
+// coefficients P. Each outer iteration computes the residual r = rhs - A u with the
+// current coefficients and corrects u by a loose multigrid solve of P e = r with
+// homogeneous boundary conditions. Since P differs from A by at most m_lagged_tol
+// this converges quickly; the iteration stops once the residual has dropped to
+// m_lagged_outer_rtol times rhs and returns false if that takes more than
+// m_lagged_max_iter iterations.
+//
+bool
+DiffusionTensorOp::lagged_solve (Vector<MultiFab*> const& velocity,
+                                 Vector<MultiFab> const& rhs,
+                                 Vector<MultiFab*> const& density,
+                                 Vector<MultiFab const*> const& eta,
+                                 Real dt)
+{
+    BL_PROFILE("DiffusionTensorOp::lagged_solve");
+
+    const int finest_level = m_incflo->finestLevel();
+
+#ifdef AMREX_USE_EB
+    MLLinOp& apply_op = m_eb_apply_op ? static_cast<MLLinOp&>(*m_eb_apply_op)
+                                      : static_cast<MLLinOp&>(*m_reg_apply_op);
+    MLLinOp& solve_op = m_eb_solve_op ? static_cast<MLLinOp&>(*m_eb_solve_op)
+                                      : static_cast<MLLinOp&>(*m_reg_solve_op);
+#else
+    MLLinOp& apply_op = *m_reg_apply_op;
+    MLLinOp& solve_op = *m_reg_solve_op;
+#endif
+
+    // A is applied with the current coefficients
+#ifdef AMREX_USE_EB
+    if (m_eb_apply_op)
+    {
+        m_eb_apply_op->setScalars(1.0, dt);
+        for (int lev = 0; lev <= finest_level; ++lev) {
+            m_eb_apply_op->setACoeffs(lev, *density[lev]);
+            Array<MultiFab,AMREX_SPACEDIM> b = m_incflo->average_velocity_eta_to_faces(lev, *eta[lev]);
+            m_eb_apply_op->setShearViscosity(lev, GetArrOfConstPtrs(b), MLMG::Location::FaceCentroid);
+            m_eb_apply_op->setEBShearViscosity(lev, *eta[lev]);
+        }
+    }
+    else
+#endif
+    {
+        m_reg_apply_op->setScalars(1.0, dt);
+        for (int lev = 0; lev <= finest_level; ++lev) {
+            m_reg_apply_op->setACoeffs(lev, *density[lev]);
+            Array<MultiFab,AMREX_SPACEDIM> b = m_incflo->average_velocity_eta_to_faces(lev, *eta[lev]);
+            m_reg_apply_op->setShearViscosity(lev, GetArrOfConstPtrs(b));
+        }
+    }
+
+    // The residual is measured on the part of each level not covered by a finer one
+    Vector<iMultiFab> masks(finest_level+1);
+    Vector<MultiFab> vel(finest_level+1), resid(finest_level+1), corr(finest_level+1);
+    for (int lev = 0; lev <= finest_level; ++lev)
+    {
+        BoxArray const& ba = velocity[lev]->boxArray();
+        DistributionMapping const& dm = velocity[lev]->DistributionMap();
+        if (lev < finest_level) {
+            masks[lev] = amrex::makeFineMask(ba, dm, velocity[lev+1]->boxArray(),
+                                             m_incflo->refRatio(lev), 1, 0);
+        } else {
+            masks[lev].define(ba, dm, 1, 0);
+            masks[lev].setVal(1);
+        }
+        vel  [lev].define(ba, dm, AMREX_SPACEDIM, 1, MFInfo(), velocity[lev]->Factory());
+        resid[lev].define(ba, dm, AMREX_SPACEDIM, 0, MFInfo(), velocity[lev]->Factory());
+        corr [lev].define(ba, dm, AMREX_SPACEDIM, 1, MFInfo(), velocity[lev]->Factory());
+
+        // The boundary values are those of the incoming velocity for A and zero for P
+        apply_op.setLevelBC(lev, velocity[lev]);
+        solve_op.setLevelBC(lev, nullptr);
+    }
+
+    auto norm = [&] (Vector<MultiFab> const& mf) -> Real
+    {
+        Real r = 0.0;
+        for (int lev = 0; lev <= finest_level; ++lev) {
+            for (int n = 0; n < AMREX_SPACEDIM; ++n) {
+                r = amrex::max(r, mf[lev].norm0(masks[lev], n, 0, true));
+            }
+        }
+        ParallelAllReduce::Max(r, ParallelContext::CommunicatorSub());
+        return r;
+    };
+
+    const Real tol = amrex::max(m_lagged_outer_rtol*norm(rhs), m_mg_atol);
+
+    MLMG apply_mlmg(apply_op);
+    MLMG solve_mlmg(solve_op);
+    setup_solver(solve_mlmg);
+
+    for (int iter = 0; iter < m_lagged_max_iter; ++iter)
+    {
+        // r = rhs - A u, on a copy since apply overwrites the ghost cells
+        for (int lev = 0; lev <= finest_level; ++lev) {
+            MultiFab::Copy(vel[lev], *velocity[lev], 0, 0, AMREX_SPACEDIM, 1);
+        }
+        apply_mlmg.apply(GetVecOfPtrs(resid), GetVecOfPtrs(vel));
+        for (int lev = 0; lev <= finest_level; ++lev) {
+            MultiFab::Xpay(resid[lev], Real(-1.0), rhs[lev], 0, 0, AMREX_SPACEDIM, 0);
+        }
+
+        const Real rnorm = norm(resid);
+        if (m_verbose > 0) {
+            amrex::Print() << "  Lagged diffusion iteration " << iter
+                           << ": residual " << rnorm << " (target " << tol << ")" << std::endl;
+        }
+        if (rnorm <= tol) return true;
+
+        // P e = r only needs to be solved loosely since the outer iteration
+        // removes what is left
+        for (int lev = 0; lev <= finest_level; ++lev) {
+            corr[lev].setVal(0.0);
+        }
+        solve_mlmg.solve(GetVecOfPtrs(corr), GetVecOfConstPtrs(resid),
+                         m_lagged_inner_rtol, m_mg_atol);
+
+        for (int lev = 0; lev <= finest_level; ++lev) {
+            MultiFab::Add(*velocity[lev], corr[lev], 0, 0, AMREX_SPACEDIM, 0);
+        }
+    }
+
+    return false;
+}
+
+void
+DiffusionTensorOp::diffuse_velocity (Vector<MultiFab*> const& velocity,
+                                     Vector<MultiFab*> const& density,
+                                     Vector<MultiFab const*> const& eta,
+                                     Real dt)
+{
+    //
+    //      alpha a - beta div ( b grad )   <--->   rho - dt div ( mu grad )
+    //
+    // So the constants and variable coefficients are:
+    //
+    //      alpha: 1
+    //      beta: dt
+    //      a: rho
+    //      b: mu
+
+    if (m_verbose > 0) {
+        amrex::Print() << "Diffusing velocity components all together..." << std::endl;
+    }
+
+    const int finest_level = m_incflo->finestLevel();
+
+    const bool use_frozen = m_lagged_tol > 0.0 and frozen_coeffs_ok(density, eta, dt);
+    if (!use_frozen) {
+        set_solve_coeffs(density, eta, dt);
+    }
+
     Vector<MultiFab> rhs(finest_level+1);
     for (int lev = 0; lev <= finest_level; ++lev) {
         rhs[lev].define(velocity[lev]->boxArray(),
@@ -176,6 +416,28 @@ DiffusionTensorOp::diffuse_velocity (Vector<MultiFab*> const& velocity,
         }
     }
 
+    if (use_frozen)
+    {
+        if (lagged_solve(velocity, rhs, density, eta, dt)) return;
+
+        // The frozen operator was not good enough: rebuild it and solve directly
+        // for what is left
+        if (m_verbose > 0) {
+            amrex::Print() << "  Lagged diffusion did not converge, rebuilding the operator" << std::endl;
+        }
+        set_solve_coeffs(density, eta, dt);
+        for (int lev = 0; lev <= finest_level; ++lev) {
+#ifdef AMREX_USE_EB
+            if (m_eb_solve_op) {
+                m_eb_solve_op->setLevelBC(lev, velocity[lev]);
+            } else
+#endif
+            {
+                m_reg_solve_op->setLevelBC(lev, velocity[lev]);
+            }
+        }
+    }
+
 #ifdef AMREX_USE_EB
     MLMG mlmg(m_eb_solve_op ? static_cast<MLLinOp&>(*m_eb_solve_op)
               :               static_cast<MLLinOp&>(*m_reg_solve_op));
@@ -183,26 +445,7 @@ DiffusionTensorOp::diffuse_velocity (Vector<MultiFab*> const& velocity,
     MLMG mlmg(*m_reg_solve_op);
 #endif
 
-    // The default bottom solver is BiCG
-    if (m_bottom_solver == "smoother")
-    {
-        mlmg.setBottomSolver(MLMG::BottomSolver::smoother);
-    }
-    else if (m_bottom_solver == "hypre")
-    {
-        mlmg.setBottomSolver(MLMG::BottomSolver::hypre);
-    }
-    // Maximum iterations for MultiGrid / ConjugateGradients
-    mlmg.setMaxIter(m_mg_max_iter);
-    mlmg.setMaxFmgIter(m_mg_max_fmg_iter);
-    mlmg.setCGMaxIter(m_mg_cg_maxiter);
-
-    // Verbosity for MultiGrid / ConjugateGradients
-    mlmg.setVerbose(m_mg_verbose);
-    mlmg.setCGVerbose(m_mg_cg_verbose);
-
-    mlmg.setPreSmooth(m_num_pre_smooth);
-    mlmg.setPostSmooth(m_num_post_smooth);
+    setup_solver(mlmg);
 
     mlmg.solve(velocity, GetVecOfConstPtrs(rhs), m_mg_rtol, m_mg_atol);
 }
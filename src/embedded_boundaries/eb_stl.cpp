@@ -0,0 +1,63 @@
+#include <AMReX_EB2.H>
+#include <AMReX_EB2_IF.H>
+#include <AMReX_ParmParse.H>
+
+#include <algorithm>
+#include <eb_triangulated_if.H>
+#include <incflo.H>
+
+using namespace amrex;
+
+/********************************************************************************
+ *                                                                              *
+ * Function to create an EB from a closed triangulated surface (STL or OBJ).   *
+ *                                                                              *
+ ********************************************************************************/
+void incflo::make_eb_stl()
+{
+    // Initialise surface parameters
+    std::string filename;
+    bool inside = false;
+    Real scale = 1.0;
+    Vector<Real> offsetvec(3, 0.0);
+
+    // Get surface information from inputs file.                               *
+    ParmParse pp("stl");
+
+    pp.get("file", filename);
+    pp.query("internal_flow", inside);
+    pp.query("scale", scale);
+    pp.queryarr("offset", offsetvec, 0, 3);
+    Array<Real, AMREX_SPACEDIM> offset = {AMREX_D_DECL(offsetvec[0], offsetvec[1], offsetvec[2])};
+
+    // Print info about surface
+    amrex::Print() << " " << std::endl;
+    amrex::Print() << " File:          " << filename << std::endl;
+    amrex::Print() << " Internal Flow: " << inside << std::endl;
+    amrex::Print() << " Scale:         " << scale << std::endl;
+    amrex::Print() << " Offset:        " << offset[0] << ", " << offset[1] << ", " << offset[2]
+                   << std::endl;
+
+    // Build the surface implicit function
+    Real strt_time = ParallelDescriptor::second();
+    TriangulatedIF my_surface(filename, scale, offset, inside);
+    Real bvh_time = ParallelDescriptor::second() - strt_time;
+    ParallelDescriptor::ReduceRealMax(bvh_time, ParallelDescriptor::IOProcessorNumber());
+
+    amrex::Print() << " Triangles:     " << my_surface.numTriangles()
+                   << " (" << my_surface.numNodes() << " BVH nodes, built in "
+                   << bvh_time << " s)" << std::endl;
+
+    // Generate GeometryShop
+    auto gshop = EB2::makeShop(my_surface);
+
+    // Build index space
+    int max_level_here = 0;
+    int max_coarsening_level = 100;
+    strt_time = ParallelDescriptor::second();
+    EB2::Build(gshop, geom.back(), max_level_here, max_level_here + max_coarsening_level);
+    Real build_time = ParallelDescriptor::second() - strt_time;
+    ParallelDescriptor::ReduceRealMax(build_time, ParallelDescriptor::IOProcessorNumber());
+
+    amrex::Print() << " EB2::Build:    " << build_time << " s" << std::endl;
+}
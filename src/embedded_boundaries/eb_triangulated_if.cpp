@@ -0,0 +1,432 @@
+#include <AMReX_BLProfiler.H>
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_Vector.H>
+
+#include <eb_triangulated_if.H>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <sstream>
+
+using namespace amrex;
+
+/********************************************************************************
+ *                                                                              *
+ * The hierarchy is stored flat: the left child of an interior node follows it  *
+ * and `first` is the index of the right child; a leaf holds `count` > 0        *
+ * triangles starting at `first`. The triangles are stored as the 9 coordinates *
+ * of their vertices, in the order of the leaves.                               *
+ *                                                                              *
+ ********************************************************************************/
+
+namespace {
+
+struct BVHNode
+{
+	Real lo[3];
+	Real hi[3];
+	int first;
+	int count;
+};
+
+constexpr int bvh_leaf_size = 4;
+constexpr int bvh_max_depth = 64;
+
+// Binary STL: 80 byte header, triangle count, then 50 bytes per triangle (normal,
+// three vertices, attribute). Anything else is read as ASCII STL.
+void read_stl(const Vector<char>& buf, Vector<Real>& tri)
+{
+	const std::size_t len = buf.size() - 1;
+	if(len >= 84)
+	{
+		std::uint32_t ntri;
+		std::memcpy(&ntri, buf.data() + 80, 4);
+		if(len == 84 + 50 * std::size_t(ntri))
+		{
+			tri.resize(9 * std::size_t(ntri));
+			for(std::size_t t = 0; t < ntri; t++)
+			{
+				const char* rec = buf.data() + 84 + 50 * t + 12;
+				for(int m = 0; m < 9; m++)
+				{
+					float x;
+					std::memcpy(&x, rec + 4 * m, 4);
+					tri[9 * t + m] = x;
+				}
+			}
+			return;
+		}
+	}
+
+	std::istringstream is(std::string(buf.data()));
+	std::string word;
+	while(is >> word)
+	{
+		if(word == "vertex")
+		{
+			Real x, y, z;
+			is >> x >> y >> z;
+			tri.push_back(x);
+			tri.push_back(y);
+			tri.push_back(z);
+		}
+	}
+}
+
+// OBJ: vertices and polygonal faces (1-based or negative relative indices), the
+// polygons are split into fans of triangles
+void read_obj(const Vector<char>& buf, Vector<Real>& tri)
+{
+	std::istringstream is(std::string(buf.data()));
+	Vector<Real> xyz;
+	std::string line;
+	while(std::getline(is, line))
+	{
+		std::istringstream ls(line);
+		std::string key;
+		ls >> key;
+		if(key == "v")
+		{
+			Real x, y, z;
+			ls >> x >> y >> z;
+			xyz.push_back(x);
+			xyz.push_back(y);
+			xyz.push_back(z);
+		}
+		else if(key == "f")
+		{
+			const int nv = xyz.size() / 3;
+			Vector<int> vid;
+			std::string s;
+			while(ls >> s)
+			{
+				int id = std::stoi(s);
+				if(id < 0)
+					id += nv + 1;
+				if(id < 1 || id > nv)
+					amrex::Abort("TriangulatedIF: bad vertex index in OBJ face");
+				vid.push_back(id - 1);
+			}
+			for(int m = 1; m + 1 < static_cast<int>(vid.size()); m++)
+			{
+				for(int v : {vid[0], vid[m], vid[m + 1]})
+				{
+					for(int c = 0; c < 3; c++)
+						tri.push_back(xyz[3 * v + c]);
+				}
+			}
+		}
+	}
+}
+
+int build_node(Vector<BVHNode>& nodes, Vector<int>& order, const Vector<Real>& cent,
+               const Vector<Real>& tri, int first, int count)
+{
+	const int inode = nodes.size();
+	nodes.push_back(BVHNode());
+
+	BVHNode nd;
+	Real clo[3], chi[3];
+	for(int d = 0; d < 3; d++)
+	{
+		nd.lo[d] = clo[d] = std::numeric_limits<Real>::max();
+		nd.hi[d] = chi[d] = std::numeric_limits<Real>::lowest();
+	}
+	for(int n = first; n < first + count; n++)
+	{
+		const int t = order[n];
+		for(int d = 0; d < 3; d++)
+		{
+			for(int v = 0; v < 3; v++)
+			{
+				nd.lo[d] = std::min(nd.lo[d], tri[9 * t + 3 * v + d]);
+				nd.hi[d] = std::max(nd.hi[d], tri[9 * t + 3 * v + d]);
+			}
+			clo[d] = std::min(clo[d], cent[3 * t + d]);
+			chi[d] = std::max(chi[d], cent[3 * t + d]);
+		}
+	}
+
+	if(count <= bvh_leaf_size)
+	{
+		nd.first = first;
+		nd.count = count;
+		nodes[inode] = nd;
+		return inode;
+	}
+
+	// Median split of the centroids along their longest extent
+	int axis = 0;
+	for(int d = 1; d < 3; d++)
+	{
+		if(chi[d] - clo[d] > chi[axis] - clo[axis])
+			axis = d;
+	}
+	const int nleft = count / 2;
+	std::nth_element(order.begin() + first, order.begin() + first + nleft,
+	                 order.begin() + first + count, [&](int a, int b) {
+		                 return cent[3 * a + axis] < cent[3 * b + axis];
+	                 });
+
+	build_node(nodes, order, cent, tri, first, nleft);
+	nd.first = build_node(nodes, order, cent, tri, first + nleft, count - nleft);
+	nd.count = 0;
+	nodes[inode] = nd;
+	return inode;
+}
+
+Real box_dist2(const BVHNode& nd, const Real* p)
+{
+	Real r = 0.0;
+	for(int d = 0; d < 3; d++)
+	{
+		const Real e = std::max({nd.lo[d] - p[d], Real(0.0), p[d] - nd.hi[d]});
+		r += e * e;
+	}
+	return r;
+}
+
+// Squared distance to the closest point of the triangle, following Ericson,
+// Real-Time Collision Detection, 5.1.5
+Real tri_dist2(const Real* t, const Real* p)
+{
+	Real ab[3], ac[3], ap[3], bp[3], cp[3], q[3];
+	for(int d = 0; d < 3; d++)
+	{
+		ab[d] = t[3 + d] - t[d];
+		ac[d] = t[6 + d] - t[d];
+		ap[d] = p[d] - t[d];
+		bp[d] = p[d] - t[3 + d];
+		cp[d] = p[d] - t[6 + d];
+	}
+	auto dot = [](const Real* u, const Real* v) { return u[0] * v[0] + u[1] * v[1] + u[2] * v[2]; };
+	auto dist2 = [&](const Real* x) {
+		return (p[0] - x[0]) * (p[0] - x[0]) + (p[1] - x[1]) * (p[1] - x[1])
+		       + (p[2] - x[2]) * (p[2] - x[2]);
+	};
+
+	const Real d1 = dot(ab, ap);
+	const Real d2 = dot(ac, ap);
+	if(d1 <= 0.0 && d2 <= 0.0)
+		return dist2(t);
+
+	const Real d3 = dot(ab, bp);
+	const Real d4 = dot(ac, bp);
+	if(d3 >= 0.0 && d4 <= d3)
+		return dist2(t + 3);
+
+	const Real vc = d1 * d4 - d3 * d2;
+	if(vc <= 0.0 && d1 >= 0.0 && d3 <= 0.0)
+	{
+		const Real v = d1 / (d1 - d3);
+		for(int d = 0; d < 3; d++)
+			q[d] = t[d] + v * ab[d];
+		return dist2(q);
+	}
+
+	const Real d5 = dot(ab, cp);
+	const Real d6 = dot(ac, cp);
+	if(d6 >= 0.0 && d5 <= d6)
+		return dist2(t + 6);
+
+	const Real vb = d5 * d2 - d1 * d6;
+	if(vb <= 0.0 && d2 >= 0.0 && d6 <= 0.0)
+	{
+		const Real w = d2 / (d2 - d6);
+		for(int d = 0; d < 3; d++)
+			q[d] = t[d] + w * ac[d];
+		return dist2(q);
+	}
+
+	const Real va = d3 * d6 - d5 * d4;
+	if(va <= 0.0 && (d4 - d3) >= 0.0 && (d5 - d6) >= 0.0)
+	{
+		const Real w = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+		for(int d = 0; d < 3; d++)
+			q[d] = t[3 + d] + w * (t[6 + d] - t[3 + d]);
+		return dist2(q);
+	}
+
+	const Real denom = 1.0 / (va + vb + vc);
+	const Real v = vb * denom;
+	const Real w = vc * denom;
+	for(int d = 0; d < 3; d++)
+		q[d] = t[d] + v * ab[d] + w * ac[d];
+	return dist2(q);
+}
+
+} // namespace
+
+struct TriangulatedIF::Surface
+{
+	Vector<Real> tri;
+	Vector<BVHNode> nodes;
+};
+
+TriangulatedIF::TriangulatedIF(const std::string& a_filename, Real a_scale,
+                               const RealArray& a_offset, bool a_inside)
+	: m_inside(a_inside)
+{
+	BL_PROFILE("TriangulatedIF::TriangulatedIF()");
+
+	std::shared_ptr<Surface> surf = std::make_shared<Surface>();
+
+	// Read once and broadcast
+	Vector<char> buf;
+	ParallelDescriptor::ReadAndBcastFile(a_filename, buf);
+
+	Vector<Real> tri;
+	const std::string ext = a_filename.substr(a_filename.find_last_of('.') + 1);
+	if(ext == "obj" || ext == "OBJ")
+		read_obj(buf, tri);
+	else
+		read_stl(buf, tri);
+
+	// Map to physical coordinates and drop the triangles without area, which the
+	// distance and crossing tests cannot handle
+	int ntri = 0;
+	for(int t = 0; t < static_cast<int>(tri.size() / 9); t++)
+	{
+		Real* v = tri.data() + 9 * t;
+		for(int m = 0; m < 9; m++)
+			v[m] = a_scale * v[m] + a_offset[m % 3];
+		const Real ab[3] = {v[3] - v[0], v[4] - v[1], v[5] - v[2]};
+		const Real ac[3] = {v[6] - v[0], v[7] - v[1], v[8] - v[2]};
+		const Real n[3] = {ab[1] * ac[2] - ab[2] * ac[1], ab[2] * ac[0] - ab[0] * ac[2],
+		                   ab[0] * ac[1] - ab[1] * ac[0]};
+		if(n[0] * n[0] + n[1] * n[1] + n[2] * n[2] > 0.0)
+		{
+			std::copy(v, v + 9, tri.data() + 9 * ntri);
+			ntri++;
+		}
+	}
+	tri.resize(9 * ntri);
+	if(ntri == 0)
+		amrex::Abort("TriangulatedIF: no triangles read from " + a_filename);
+
+	Vector<Real> cent(3 * ntri);
+	Vector<int> order(ntri);
+	for(int t = 0; t < ntri; t++)
+	{
+		order[t] = t;
+		for(int d = 0; d < 3; d++)
+			cent[3 * t + d] = (tri[9 * t + d] + tri[9 * t + 3 + d] + tri[9 * t + 6 + d]) / 3.0;
+	}
+
+	surf->nodes.reserve(2 * (ntri / bvh_leaf_size + 1));
+	build_node(surf->nodes, order, cent, tri, 0, ntri);
+
+	surf->tri.resize(9 * ntri);
+	for(int n = 0; n < ntri; n++)
+		std::copy(tri.data() + 9 * order[n], tri.data() + 9 * order[n] + 9, surf->tri.data() + 9 * n);
+
+	m_surf = surf;
+}
+
+int TriangulatedIF::numTriangles() const
+{
+	return m_surf->tri.size() / 9;
+}
+
+int TriangulatedIF::numNodes() const
+{
+	return m_surf->nodes.size();
+}
+
+Real TriangulatedIF::operator()(const RealArray& a_p) const
+{
+	const Real p[3] = {a_p[0], a_p[1], a_p[2]};
+	const BVHNode* nodes = m_surf->nodes.data();
+	const Real* tri = m_surf->tri.data();
+
+	int stack[bvh_max_depth];
+	int top;
+
+	// Nearest triangle, visiting the closer child first
+	Real best = std::numeric_limits<Real>::max();
+	top = 0;
+	stack[top++] = 0;
+	while(top > 0)
+	{
+		const int in = stack[--top];
+		const BVHNode& nd = nodes[in];
+		if(box_dist2(nd, p) >= best)
+			continue;
+		if(nd.count > 0)
+		{
+			for(int t = nd.first; t < nd.first + nd.count; t++)
+				best = std::min(best, tri_dist2(tri + 9 * t, p));
+		}
+		else
+		{
+			const int l = in + 1;
+			const int r = nd.first;
+			if(box_dist2(nodes[l], p) < box_dist2(nodes[r], p))
+			{
+				stack[top++] = r;
+				stack[top++] = l;
+			}
+			else
+			{
+				stack[top++] = l;
+				stack[top++] = r;
+			}
+		}
+	}
+
+	// Crossings of the rays from p in the +x, +y and +z directions. A ray through
+	// an edge or a vertex may be counted wrong, so the three rays vote.
+	int votes = 0;
+	for(int d = 0; d < 3; d++)
+	{
+		const int d1 = (d + 1) % 3;
+		const int d2 = (d + 2) % 3;
+		int crossings = 0;
+		top = 0;
+		stack[top++] = 0;
+		while(top > 0)
+		{
+			const int in = stack[--top];
+			const BVHNode& nd = nodes[in];
+			if(p[d1] < nd.lo[d1] || p[d1] > nd.hi[d1] || p[d2] < nd.lo[d2] || p[d2] > nd.hi[d2]
+			   || p[d] > nd.hi[d])
+				continue;
+			if(nd.count > 0)
+			{
+				for(int t = nd.first; t < nd.first + nd.count; t++)
+				{
+					const Real* a = tri + 9 * t;
+					const Real* b = a + 3;
+					const Real* c = a + 6;
+					const Real e0 = (b[d1] - p[d1]) * (c[d2] - p[d2]) - (b[d2] - p[d2]) * (c[d1] - p[d1]);
+					const Real e1 = (c[d1] - p[d1]) * (a[d2] - p[d2]) - (c[d2] - p[d2]) * (a[d1] - p[d1]);
+					const Real e2 = (a[d1] - p[d1]) * (b[d2] - p[d2]) - (a[d2] - p[d2]) * (b[d1] - p[d1]);
+					const bool hit = (e0 >= 0.0 && e1 >= 0.0 && e2 >= 0.0)
+					                 || (e0 <= 0.0 && e1 <= 0.0 && e2 <= 0.0);
+					const Real esum = e0 + e1 + e2;
+					if(hit && esum != 0.0)
+					{
+						const Real x = (e0 * a[d] + e1 * b[d] + e2 * c[d]) / esum;
+						if(x > p[d])
+							crossings++;
+					}
+				}
+			}
+			else
+			{
+				stack[top++] = in + 1;
+				stack[top++] = nd.first;
+			}
+		}
+		votes += crossings % 2;
+	}
+	const bool inside = (votes >= 2);
+
+	// Negative in the fluid: inside the surface for internal flows, outside otherwise
+	const Real dist = std::sqrt(best);
+	const Real val = inside ? -dist : dist;
+	return m_inside ? val : -val;
+}
@@ -9,7 +9,7 @@ void incflo::MakeEBGeometry()
 {
    /******************************************************************************
    * incflo.geometry=<string> specifies the EB geometry. <string> can be one of    *
-   * box, cylinder, annulus, sphere, spherecube, twocylinders
+   * box, cylinder, annulus, sphere, spherecube, twocylinders, stl
    ******************************************************************************/
 
     ParmParse pp("incflo");
@@ -49,6 +49,11 @@ void incflo::MakeEBGeometry()
 	amrex::Print() << "\n Building tuscan geometry." << std::endl;
         make_eb_tuscan();
     }
+    else if(geom_type == "stl")
+    {
+        amrex::Print() << "\n Building geometry from triangulated surface." << std::endl;
+        make_eb_stl();
+    }
 #endif
     else if(geom_type == "annulus")
     {
@@ -29,6 +29,8 @@ incflo::incflo ()
     init_advection();
 
     set_background_pressure();
+
+    select_update_kernels();
 }
 
 incflo::~incflo ()
@@ -74,8 +76,11 @@ void incflo::InitData ()
         }
         if (m_KE_int > 0)
         {
-            amrex::Abort("xxxxx m_KE_int todo");
-//          amrex::Print() << "Time, Kinetic Energy: " << m_cur_time << ", " << ComputeKineticEnergy() << std::endl;
+            PrintIntegrals(m_cur_time);
+        }
+        if (m_diag_int > 0)
+        {
+            WriteReducedDiagnostics();
         }
     }
     else
@@ -117,10 +122,12 @@ void incflo::Evolve()
             amrex::Print() << "\n ============   NEW TIME STEP   ============ \n";
         }
 
-        if (m_regrid_int > 0 and m_nstep > 0 and m_nstep%m_regrid_int == 0)
+        if (regridNow())
         {
             if (m_verbose > 0) amrex::Print() << "Regridding...\n";
             regrid(0, m_cur_time);
+            m_last_regrid = m_nstep;
+            m_regrid_cells_moved = 0.0;
             if (m_verbose > 0 and ParallelDescriptor::IOProcessor()) {
                 printGridSummary(amrex::OutStream(), 0, finest_level);
             }
@@ -130,6 +137,12 @@ void incflo::Evolve()
         Advance();
         m_nstep++;
         m_cur_time += m_dt;
+        m_regrid_cells_moved += m_dt * m_regrid_cell_rate;
+
+        if (m_stats_int > 0 && m_cur_time > m_stats_start_time)
+        {
+            UpdateStatistics(m_dt);
+        }
 
         if (writeNow())
         {
@@ -145,7 +158,17 @@ void incflo::Evolve()
         
         if(m_KE_int > 0 && (m_nstep % m_KE_int == 0))
         {
-            amrex::Print() << "Time, Kinetic Energy: " << m_cur_time << ", " << ComputeKineticEnergy() << std::endl;
+            PrintIntegrals(m_cur_time);
+        }
+
+        if(m_diag_int > 0 && (m_nstep % m_diag_int == 0))
+        {
+            WriteReducedDiagnostics();
+        }
+
+        if(m_stats_int > 0 && (m_nstep % m_stats_int == 0))
+        {
+            WriteStatistics();
         }
 
         // Mechanism to terminate incflo normally.
@@ -184,15 +207,7 @@ void incflo::MakeNewLevelFromScratch (int lev, Real time, const BoxArray& new_gr
     SetBoxArray(lev, new_grids);
     SetDistributionMap(lev, new_dmap);
 
-#ifdef AMREX_USE_EB
-    m_factory[lev] = makeEBFabFactory(geom[lev], grids[lev], dmap[lev],
-                                      {nghost_eb_basic(),
-                                       nghost_eb_volume(),
-                                       nghost_eb_full()},
-                                       EBSupport::full);
-#else
-    m_factory[lev].reset(new FArrayBoxFactory());
-#endif
+    m_factory[lev] = make_factory(lev, grids[lev], dmap[lev]);
 
     m_leveldata[lev].reset(new LevelData(grids[lev], dmap[lev], *m_factory[lev],
                                          m_ntrac, nghost_state(),
@@ -201,14 +216,38 @@ void incflo::MakeNewLevelFromScratch (int lev, Real time, const BoxArray& new_gr
                                            use_tensor_correction,
                                          m_advect_tracer));
 
+    if (m_stats_int > 0) {
+        m_stats[lev].define(grids[lev], dmap[lev], nstats(), 0, MFInfo(), *m_factory[lev]);
+        m_stats[lev].setVal(0.0);
+    }
+
     m_t_new[lev] = time;
     m_t_old[lev] = time - 1.e200;
 
+    clear_diag_caches();
+
     if (m_restart_file.empty()) {
         prob_init_fluid(lev);
     }
 }
 
+// With amr.regrid_adaptive the regrid interval follows the flow: we regrid once the
+// fastest velocity on the levels that tag could have moved features across the
+// error buffer, with amr.regrid_int (if > 0) as the longest allowed interval.
+bool
+incflo::regridNow () const
+{
+    if (m_nstep == 0) return false;
+
+    if (m_regrid_adaptive)
+    {
+        return (m_regrid_cells_moved >= m_regrid_buffer_cells) or
+               (m_regrid_int > 0 and m_nstep - m_last_regrid >= m_regrid_int);
+    }
+
+    return m_regrid_int > 0 and m_nstep%m_regrid_int == 0;
+}
+
 bool
 incflo::writeNow()
 {
@@ -59,22 +59,23 @@ void incflo::Advance()
     if (m_verbose > 2)
     {
         amrex::Print() << "End of time step: " << std::endl;
-#if 0
-        // xxxxx
-        PrintMaxValues(m_cur_time + dt);
-        if(m_probtype%10 == 3 or m_probtype == 5)
+        PrintMaxValues(m_cur_time + m_dt);
+#ifdef AMREX_USE_EB
+        if (m_diag_eb_forces)
         {
-            ComputeDrag();
-            amrex::Print() << "Drag force = " << (*drag[0]).sum(0, false) << std::endl;
+            Vector<double> forces = ComputeEBForces(m_cur_time + m_dt);
+            amrex::Print() << "EB force = " << AMREX_D_TERM(forces[0], << "  " << forces[1],
+                                                            << "  " << forces[2]) << std::endl;
         }
 #endif
     }
 
-#if 0
     if (m_test_tracer_conservation) {
-        amrex::Print() << "Sum tracer volume wgt = " << m_cur_time+dt << "   " << volWgtSum(0,*tracer[0],0) << std::endl;
+        Vector<double> integrals = ComputeIntegrals(m_cur_time+m_dt);
+        amrex::Print() << "Sum tracer (rho s) volume wgt = " << m_cur_time+m_dt;
+        for (int n = 0; n < m_ntrac; ++n) amrex::Print() << "   " << integrals[3+n];
+        amrex::Print() << std::endl;
     }
-#endif
 
     // Stop timing current time step
     Real end_step = ParallelDescriptor::second() - strt_step;
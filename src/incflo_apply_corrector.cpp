@@ -154,135 +154,16 @@ void incflo::ApplyCorrector()
     }
 
     // *************************************************************************************
-    // Define local variables for lambda to capture.
-    // *************************************************************************************
-    Real l_dt = m_dt;
-    bool l_constant_density = m_constant_density;
-    int l_ntrac = (m_advect_tracer) ? m_ntrac : 0;
-
-    // *************************************************************************************
-    // Update density first
-    // *************************************************************************************
-    if (l_constant_density)
-    {
-        for (int lev = 0; lev <= finest_level; lev++)
-            MultiFab::Copy(density_nph[lev], m_leveldata[lev]->density_o, 0, 0, 1, 0);
-    } else {
-        for (int lev = 0; lev <= finest_level; lev++)
-        {
-            auto& ld = *m_leveldata[lev];
-#ifdef _OPENMP
-#pragma omp parallel if (Gpu::notInLaunchRegion())
-#endif
-            for (MFIter mfi(ld.velocity,TilingIfNotGPU()); mfi.isValid(); ++mfi)
-            {
-                Box const& bx = mfi.tilebox();
-                Array4<Real const> const& rho_o  = ld.density_o.const_array(mfi);
-                Array4<Real> const& rho_n        = ld.density.array(mfi);
-                Array4<Real> const& rho_nph      = density_nph[lev].array(mfi);
-                Array4<Real const> const& drdt_o = ld.conv_density_o.const_array(mfi);
-                Array4<Real const> const& drdt   = ld.conv_density.const_array(mfi);
-
-                amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
-                {
-                    const Real rho_old = rho_o(i,j,k);
-
-                    Real rho_new = rho_old + l_dt * 0.5*(drdt(i,j,k)+drdt_o(i,j,k));
-                    rho_nph(i,j,k) = 0.5 * (rho_old + rho_new);
-
-                    rho_n  (i,j,k) = rho_new;
-                });
-            } // mfi
-        } // lev
-    } // not constant density
-
-    // *************************************************************************************
-    // Compute the tracer forcing terms (forcing for (rho s), not for s)
-    // *************************************************************************************
-    if (m_advect_tracer)
-        compute_tra_forces(GetVecOfPtrs(tra_forces),  GetVecOfConstPtrs(density_nph));
-
-    // *************************************************************************************
-    // Update the tracer next (note that dtdt already has rho in it)
+    // Update density, tracer and (unless Boussinesq) velocity in a single pass
+    // (note that dtdt already has rho in it)
     // (rho trac)^new = (rho trac)^old + dt * (
     //                   div(rho trac u) + div (mu grad trac) + rho * f_t
+    // The tracer forcing is for s here, it is multiplied by rho^nph in the update.
     // *************************************************************************************
     if (m_advect_tracer)
-    {
-        for (int lev = 0; lev <= finest_level; lev++)
-        {
-            auto& ld = *m_leveldata[lev];
-#ifdef _OPENMP
-#pragma omp parallel if (Gpu::notInLaunchRegion())
-#endif
-            for (MFIter mfi(ld.tracer,TilingIfNotGPU()); mfi.isValid(); ++mfi)
-            {
-                Box const& bx = mfi.tilebox();
-                Array4<Real const> const& tra_o   = ld.tracer_o.const_array(mfi);
-                Array4<Real const> const& rho_o   = ld.density_o.const_array(mfi);
-                Array4<Real      > const& tra     = ld.tracer.array(mfi);
-                Array4<Real const> const& rho     = ld.density.const_array(mfi);
-                Array4<Real const> const& dtdt_o  = ld.conv_tracer_o.const_array(mfi);
-                Array4<Real const> const& dtdt    = ld.conv_tracer.const_array(mfi);
-                Array4<Real const> const& tra_f   = (l_ntrac > 0) ? tra_forces[lev].const_array(mfi)
-                                                                : Array4<Real const>{};
-
-                if (m_diff_type == DiffusionType::Explicit) 
-                {
-                    Array4<Real const> const& laps_o = (l_ntrac > 0) ? ld.laps_o.const_array(mfi)
-                                                                     : Array4<Real const>{};
-                    Array4<Real const> const& laps   = (l_ntrac > 0) ? ld.laps.const_array(mfi)
-                                                                     : Array4<Real const>{};
-                    amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
-                    {
-                        for (int n = 0; n < l_ntrac; ++n) 
-                        {
-                            Real tra_new = rho_o(i,j,k)*tra_o(i,j,k,n) + l_dt * (
-                                  0.5*(  dtdt(i,j,k,n) + dtdt_o(i,j,k,n))
-                                 +0.5*(laps_o(i,j,k,n) +   laps(i,j,k,n))
-                                   +    tra_f(i,j,k,n) );
-
-                            tra_new /= rho(i,j,k);
-                            tra(i,j,k,n) = tra_new;
-                        }
-                    });
-                } 
-                else if (m_diff_type == DiffusionType::Crank_Nicolson) 
-                {
-                    Array4<Real const> const& laps_o = (l_ntrac > 0) ? ld.laps_o.const_array(mfi)
-                                                                     : Array4<Real const>{};
-                    amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
-                    {
-                        for (int n = 0; n < l_ntrac; ++n) 
-                        {
-                            Real tra_new = rho_o(i,j,k)*tra_o(i,j,k,n) + l_dt * (
-                                  0.5*(  dtdt(i,j,k,n) + dtdt_o(i,j,k,n))
-                                 +0.5*(laps_o(i,j,k,n)                  )
-                                   +    tra_f(i,j,k,n) );
+        compute_tra_forces(GetVecOfPtrs(tra_forces), {});
 
-                            tra_new /= rho(i,j,k);
-                            tra(i,j,k,n) = tra_new;
-                        }
-                    });
-                } 
-                else if (m_diff_type == DiffusionType::Implicit) 
-                {
-                    amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
-                    {
-                        for (int n = 0; n < l_ntrac; ++n) 
-                        {
-                            Real tra_new = rho_o(i,j,k)*tra_o(i,j,k,n) + l_dt * (
-                                  0.5*(  dtdt(i,j,k,n)+dtdt_o(i,j,k,n))
-                                 +      tra_f(i,j,k,n) );
-
-                            tra_new /= rho(i,j,k);
-                            tra(i,j,k,n) = tra_new;
-                        }
-                    });
-                }
-            } // mfi
-        } // lev
-    } // if (m_advect_tracer)
+    (this->*m_corrector_update_state)(density_nph, tra_forces);
 
     // *************************************************************************************
     // Solve diffusion equation for tracer
@@ -298,87 +179,19 @@ void incflo::ApplyCorrector()
         diffuse_scalar(get_tracer_new(), get_density_new(), GetVecOfConstPtrs(tra_eta), dt_diff);
     }
 
-    // *************************************************************************************
-    // Define the forcing terms to use in the final update (using half-time density)
-    // *************************************************************************************
-    compute_vel_forces(GetVecOfPtrs(vel_forces), get_velocity_new_const(), 
-                       GetVecOfConstPtrs(density_nph), 
-                       get_tracer_old_const(), get_tracer_new_const());
-
-    // *************************************************************************************
-    // Update velocity
-    // *************************************************************************************
-    for (int lev = 0; lev <= finest_level; ++lev)
+    if (!m_fuse_velocity_update)
     {
-        auto& ld = *m_leveldata[lev];
-
-#ifdef _OPENMP
-#pragma omp parallel if (Gpu::notInLaunchRegion())
-#endif
-        for (MFIter mfi(ld.velocity,TilingIfNotGPU()); mfi.isValid(); ++mfi)
-        {
-            Box const& bx = mfi.tilebox();
-            Array4<Real> const& vel = ld.velocity.array(mfi);
-            Array4<Real const> const& vel_o = ld.velocity_o.const_array(mfi);
-            Array4<Real const> const& dvdt = ld.conv_velocity.const_array(mfi);
-            Array4<Real const> const& dvdt_o = ld.conv_velocity_o.const_array(mfi);
-            Array4<Real const> const& vel_f = vel_forces[lev].const_array(mfi);
-
-            if (m_diff_type == DiffusionType::Explicit) 
-            {
-                Array4<Real const> const& divtau_o = ld.divtau_o.const_array(mfi);
-                Array4<Real const> const& divtau   = ld.divtau.const_array(mfi);
-                amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
-                {
-                    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
-                        vel(i,j,k,idim) = vel_o(i,j,k,idim) + l_dt * (
-                             0.5*(  dvdt_o(i,j,k,idim)+  dvdt(i,j,k,idim))
-                            +0.5*(divtau_o(i,j,k,idim)+divtau(i,j,k,idim))
-                            +        vel_f(i,j,k,idim) );
-                    }
-                });
-            } 
-            else if (m_diff_type == DiffusionType::Crank_Nicolson)
-            { 
-                Array4<Real const> const& divtau_o = ld.divtau_o.const_array(mfi);
-                amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
-                {
-                    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
-                        vel(i,j,k,idim) = vel_o(i,j,k,idim) + l_dt * (
-                            0.5*(  dvdt_o(i,j,k,idim)+dvdt(i,j,k,idim))
-                           +0.5*(divtau_o(i,j,k,idim)                 )
-                           +        vel_f(i,j,k,idim) );
-                    }
-                });
-            }
-            else if (m_diff_type == DiffusionType::Implicit)
-            {
-                if (use_tensor_correction) 
-                {
-                    Array4<Real const> const& divtau   = ld.divtau.const_array(mfi);
-                    amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
-                    {
-                        for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) 
-                        {
-                            // Here divtau is the difference of tensor and scalar divtau!
-                            vel(i,j,k,idim) = vel_o(i,j,k,idim) + l_dt * (
-                                 0.5*(  dvdt_o(i,j,k,idim)+dvdt(i,j,k,idim))
-                                +        vel_f(i,j,k,idim) + divtau(i,j,k,idim));
-                        }
-                    });
-                } else {
-                    amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
-                    {
-                        for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) 
-                        {
-                            vel(i,j,k,idim) = vel_o(i,j,k,idim) + l_dt * (
-                                 0.5*(  dvdt_o(i,j,k,idim)+dvdt(i,j,k,idim))
-                                +        vel_f(i,j,k,idim) );
-                        }
-                    });
-                }
-            } 
-        }
+        // *********************************************************************************
+        // Define the forcing terms to use in the final update (using half-time density)
+        // *********************************************************************************
+        compute_vel_forces(GetVecOfPtrs(vel_forces), get_velocity_new_const(), 
+                           GetVecOfConstPtrs(density_nph), 
+                           get_tracer_old_const(), get_tracer_new_const());
+
+        // *********************************************************************************
+        // Update velocity
+        // *********************************************************************************
+        (this->*m_corrector_update_velocity)(vel_forces);
     }
 
     // **********************************************************************************************
@@ -190,128 +190,13 @@ void incflo::ApplyPredictor (bool incremental_projection)
                             m_cur_time);
     
     // *************************************************************************************
-    // Define local variables for lambda to capture.
+    // Update density, tracer and (unless Boussinesq) velocity in a single pass.
+    // The tracer forcing is for s here, it is multiplied by rho^nph in the update.
     // *************************************************************************************
-    Real l_dt = m_dt;
-    bool l_constant_density = m_constant_density;
-
-    // *************************************************************************************
-    // Update density first
-    // *************************************************************************************
-    if (l_constant_density) 
-    {
-        for (int lev = 0; lev <= finest_level; lev++)
-            MultiFab::Copy(density_nph[lev], m_leveldata[lev]->density_o, 0, 0, 1, 1);
-    } else {
-        for (int lev = 0; lev <= finest_level; lev++)
-        {
-            auto& ld = *m_leveldata[lev];
-#ifdef _OPENMP
-#pragma omp parallel if (Gpu::notInLaunchRegion())
-#endif
-            for (MFIter mfi(ld.velocity,TilingIfNotGPU()); mfi.isValid(); ++mfi)
-            {
-                Box const& bx = mfi.tilebox();
-                Array4<Real  const> const& rho_o  = ld.density_o.const_array(mfi);
-                Array4<Real> const& rho_new       = ld.density.array(mfi);
-                Array4<Real> const& rho_nph       = density_nph[lev].array(mfi);
-                Array4<Real const> const& drdt    = ld.conv_density_o.const_array(mfi);
-
-                amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
-                {
-                    const Real rho_old = rho_o(i,j,k);
-
-                    Real rho = rho_old + l_dt * drdt(i,j,k);
-                    rho_nph(i,j,k) = 0.5 * (rho_old + rho);
-
-                    rho_new(i,j,k) = rho;
-                });
-            } // mfi
-        } // lev
-
-    } // not constant density
-
-    // *************************************************************************************
-    // Compute (or if Godunov, re-compute) the tracer forcing terms (forcing for (rho s), not for s)
-    // *************************************************************************************
-    if (m_advect_tracer)
-       compute_tra_forces(GetVecOfPtrs(tra_forces), GetVecOfConstPtrs(density_nph));
-
-    // *************************************************************************************
-    // Update the tracer next
-    // *************************************************************************************
-    int l_ntrac = (m_advect_tracer) ? m_ntrac : 0;
-
     if (m_advect_tracer)
-    {
-        for (int lev = 0; lev <= finest_level; lev++)
-        {
-            auto& ld = *m_leveldata[lev];
-#ifdef _OPENMP
-#pragma omp parallel if (Gpu::notInLaunchRegion())
-#endif
-            for (MFIter mfi(ld.tracer,TilingIfNotGPU()); mfi.isValid(); ++mfi)
-            {
-                Box const& bx = mfi.tilebox();
-                Array4<Real const> const& tra_o   = ld.tracer_o.const_array(mfi);
-                Array4<Real const> const& rho_o   = ld.density_o.const_array(mfi);
-                Array4<Real> const& tra           = ld.tracer.array(mfi);
-                Array4<Real const> const& rho     = ld.density.const_array(mfi);
-                Array4<Real const> const& dtdt_o  = ld.conv_tracer_o.const_array(mfi);
-                Array4<Real const> const& tra_f   = (l_ntrac > 0) ? tra_forces[lev].const_array(mfi)
-                                                                  : Array4<Real const>{};
-
-                if (m_diff_type == DiffusionType::Explicit) 
-                {
-                    Array4<Real const> const& laps_o = (l_ntrac > 0) ? ld.laps_o.const_array(mfi)
-                                                                     : Array4<Real const>{};
-                    amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
-                    {
-                        // (rho trac)^new = (rho trac)^old + dt * (
-                        //                   div(rho trac u) + div (mu grad trac) + rho * f_t 
-                        for (int n = 0; n < l_ntrac; ++n) 
-                        {
-                            Real tra_new = rho_o(i,j,k)*tra_o(i,j,k,n) + l_dt *
-                                ( dtdt_o(i,j,k,n) + tra_f(i,j,k,n) + laps_o(i,j,k,n) );
-
-                            tra_new /= rho(i,j,k);
-                            tra(i,j,k,n) = tra_new;
-                        }
-                    });
-                }
-                else if (m_diff_type == DiffusionType::Crank_Nicolson) 
-                {
-                    Array4<Real const> const& laps_o = (l_ntrac > 0) ? ld.laps_o.const_array(mfi)
-                                                                     : Array4<Real const>{};
-                    amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
-                    {
-                        for (int n = 0; n < l_ntrac; ++n) 
-                        {
-                            Real tra_new = rho_o(i,j,k)*tra_o(i,j,k,n) + l_dt *
-                                ( dtdt_o(i,j,k,n) + tra_f(i,j,k,n) + 0.5 * laps_o(i,j,k,n) );
-
-                            tra_new /= rho(i,j,k);
-                            tra(i,j,k,n) = tra_new;
-                        }
-                    });
-                } 
-                else if (m_diff_type == DiffusionType::Implicit) 
-                {
-                    amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
-                    {
-                        for (int n = 0; n < l_ntrac; ++n) 
-                        {
-                            Real tra_new = rho_o(i,j,k)*tra_o(i,j,k,n) + l_dt *
-                                ( dtdt_o(i,j,k,n) + tra_f(i,j,k,n) );
+       compute_tra_forces(GetVecOfPtrs(tra_forces), {});
 
-                            tra_new /= rho(i,j,k);
-                            tra(i,j,k,n) = tra_new;
-                        }
-                    });
-                }
-            } // mfi
-        } // lev
-    } // if (m_advect_tracer)
+    (this->*m_predictor_update_state)(density_nph, tra_forces);
 
     // *************************************************************************************
     // Solve diffusion equation for tracer
@@ -328,75 +213,21 @@ void incflo::ApplyPredictor (bool incremental_projection)
 
     } // if (m_advect_tracer)
 
-    // *************************************************************************************
-    // Define (or if use_godunov, re-define) the forcing terms, without the viscous terms 
-    //    and using the half-time density
-    // *************************************************************************************
-    compute_vel_forces(GetVecOfPtrs(vel_forces), get_velocity_old_const(), 
-                       GetVecOfConstPtrs(density_nph),
-                       get_tracer_old_const(), get_tracer_new_const());
-
-
-    // *************************************************************************************
-    // Update the velocity
-    // *************************************************************************************
-    for (int lev = 0; lev <= finest_level; lev++)
+    if (!m_fuse_velocity_update)
     {
-        auto& ld = *m_leveldata[lev];
-#ifdef _OPENMP
-#pragma omp parallel if (Gpu::notInLaunchRegion())
-#endif
-        for (MFIter mfi(ld.velocity,TilingIfNotGPU()); mfi.isValid(); ++mfi)
-        {
-            Box const& bx = mfi.tilebox();
-            Array4<Real> const& vel = ld.velocity.array(mfi);
-            Array4<Real const> const& dvdt = ld.conv_velocity_o.const_array(mfi);
-            Array4<Real const> const& vel_f = vel_forces[lev].const_array(mfi);
-
-            if (m_diff_type == DiffusionType::Implicit) {
-
-                if (use_tensor_correction)
-                {
-                    Array4<Real const> const& divtau_o = ld.divtau_o.const_array(mfi);
-                    amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
-                    {
-                        // Here divtau_o is the difference of tensor and scalar divtau_o!
-                        AMREX_D_TERM(vel(i,j,k,0) += l_dt*(dvdt(i,j,k,0)+vel_f(i,j,k,0)+divtau_o(i,j,k,0));,
-                                     vel(i,j,k,1) += l_dt*(dvdt(i,j,k,1)+vel_f(i,j,k,1)+divtau_o(i,j,k,1));,
-                                     vel(i,j,k,2) += l_dt*(dvdt(i,j,k,2)+vel_f(i,j,k,2)+divtau_o(i,j,k,2)););
-                    });
-                } else {
-                    amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
-                    {
-                        AMREX_D_TERM(vel(i,j,k,0) += l_dt*(dvdt(i,j,k,0)+vel_f(i,j,k,0));,
-                                     vel(i,j,k,1) += l_dt*(dvdt(i,j,k,1)+vel_f(i,j,k,1));,
-                                     vel(i,j,k,2) += l_dt*(dvdt(i,j,k,2)+vel_f(i,j,k,2)););
-                    });
-                }
-            } 
-            else if (m_diff_type == DiffusionType::Crank_Nicolson) 
-            {
+        // *********************************************************************************
+        // Define (or if use_godunov, re-define) the forcing terms, without the viscous terms 
+        //    and using the half-time density and the diffused tracer
+        // *********************************************************************************
+        compute_vel_forces(GetVecOfPtrs(vel_forces), get_velocity_old_const(), 
+                           GetVecOfConstPtrs(density_nph),
+                           get_tracer_old_const(), get_tracer_new_const());
 
-                Array4<Real const> const& divtau_o = ld.divtau_o.const_array(mfi);
-                amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
-                {
-                    AMREX_D_TERM(vel(i,j,k,0) += l_dt*(dvdt(i,j,k,0)+vel_f(i,j,k,0)+0.5*divtau_o(i,j,k,0));,
-                                 vel(i,j,k,1) += l_dt*(dvdt(i,j,k,1)+vel_f(i,j,k,1)+0.5*divtau_o(i,j,k,1));,
-                                 vel(i,j,k,2) += l_dt*(dvdt(i,j,k,2)+vel_f(i,j,k,2)+0.5*divtau_o(i,j,k,2)););
-                });
-            }
-            else if (m_diff_type == DiffusionType::Explicit) 
-            {
-                Array4<Real const> const& divtau_o = ld.divtau_o.const_array(mfi);
-                amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
-                {
-                    AMREX_D_TERM(vel(i,j,k,0) += l_dt*(dvdt(i,j,k,0)+vel_f(i,j,k,0)+divtau_o(i,j,k,0));,
-                                 vel(i,j,k,1) += l_dt*(dvdt(i,j,k,1)+vel_f(i,j,k,1)+divtau_o(i,j,k,1));,
-                                 vel(i,j,k,2) += l_dt*(dvdt(i,j,k,2)+vel_f(i,j,k,2)+divtau_o(i,j,k,2)););
-                });
-            }
-        } // mfi
-    } // lev
+        // *********************************************************************************
+        // Update the velocity
+        // *********************************************************************************
+        (this->*m_predictor_update_velocity)(vel_forces);
+    }
 
     // *************************************************************************************
     // Solve diffusion equation for u* but using eta_old at old time
@@ -429,3 +260,4 @@ void incflo::ApplyPredictor (bool incremental_projection)
                                AMREX_D_DECL(GetVecOfConstPtrs(u_mac), GetVecOfConstPtrs(v_mac),
                                GetVecOfConstPtrs(w_mac)));
 }
+
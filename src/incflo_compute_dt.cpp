@@ -33,6 +33,10 @@ void incflo::ComputeDt (int initialization, bool explicit_diffusion)
     Real conv_cfl = 0.0;
     Real diff_cfl = 0.0;
     Real forc_cfl = 0.0;
+    Real tag_cfl  = 0.0;
+
+    // Convective limit per level, only reported with verbose > 1
+    Vector<Real> conv_cfl_lev(finest_level+1, 0.0);
 
     for (int lev = 0; lev <= finest_level; ++lev)
     {
@@ -169,6 +173,10 @@ void incflo::ComputeDt (int initialization, bool explicit_diffusion)
 
         forc_cfl = std::max(forc_cfl, forc_lev);
         conv_cfl = std::max(conv_cfl, conv_lev);
+        conv_cfl_lev[lev] = conv_lev;
+        if (lev < max_level) {
+            tag_cfl = std::max(tag_cfl, conv_lev);
+        }
         diff_cfl = std::max(diff_cfl, diff_lev*2.0_rt*(dxinv[0]*dxinv[0]+dxinv[1]*dxinv[1]+
                                                        dxinv[2]*dxinv[2]));
     }
@@ -187,6 +195,27 @@ void incflo::ComputeDt (int initialization, bool explicit_diffusion)
     ParallelAllReduce::Max<Real>(forc_cfl,
                                  ParallelContext::CommunicatorSub());
 
+    // Cells per unit time that features can travel on the levels we tag on
+    if (m_regrid_adaptive)
+    {
+        ParallelAllReduce::Max<Real>(tag_cfl,
+                                     ParallelContext::CommunicatorSub());
+        m_regrid_cell_rate = tag_cfl;
+    }
+
+    // All levels advance with the same dt. Report how far below its own convective
+    // limit each level runs, which is the step ratio subcycling in time would recover.
+    if (m_verbose > 1)
+    {
+        ParallelDescriptor::ReduceRealMax(conv_cfl_lev.data(), conv_cfl_lev.size());
+        for (int lev = 0; lev <= finest_level; ++lev) {
+            if (conv_cfl_lev[lev] > 0.0) {
+                amrex::Print() << "Level " << lev << ": convective dt limit = "
+                               << m_cfl / conv_cfl_lev[lev] << std::endl;
+            }
+        }
+    }
+
     // Combined CFL conditioner
     Real comb_cfl = cd_cfl + std::sqrt(cd_cfl*cd_cfl + 4.0 * forc_cfl);
 
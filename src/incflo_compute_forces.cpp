@@ -1,4 +1,5 @@
 #include <incflo.H>
+#include <incflo_forces_K.H>
 
 using namespace amrex;
 
@@ -6,6 +7,9 @@ void incflo::compute_tra_forces (Vector<MultiFab*> const& tra_forces,
                                  Vector<MultiFab const*> const& density)
 {
     // NOTE: this routine must return the force term for the update of (rho s), NOT just s.
+    //       If density is empty the force term for s is returned instead, for callers
+    //       that multiply by the density themselves.
+    const bool times_rho = !density.empty();
     if (m_advect_tracer) {
 #ifdef _OPENMP
 #pragma omp parallel if (Gpu::notInLaunchRegion())
@@ -15,7 +19,8 @@ void incflo::compute_tra_forces (Vector<MultiFab*> const& tra_forces,
             {
                 Box const& bx = mfi.tilebox();
                 Array4<Real>       const& tra_f = tra_forces[lev]->array(mfi);
-                Array4<Real const> const& rho   =    density[lev]->const_array(mfi);
+                Array4<Real const> const& rho   = (times_rho) ? density[lev]->const_array(mfi)
+                                                              : Array4<Real const>{};
 
                 amrex::ParallelFor(bx, m_ntrac,
                 [=] AMREX_GPU_DEVICE (int i, int j, int k, int n) noexcept
@@ -24,7 +29,7 @@ void incflo::compute_tra_forces (Vector<MultiFab*> const& tra_forces,
                     tra_f(i,j,k,n) = 0.0;
     
                     // Return the force term for the update of (rho s), NOT just s.
-                    tra_f(i,j,k,n) *= rho(i,j,k);
+                    if (times_rho) tra_f(i,j,k,n) *= rho(i,j,k);
                 });
             }
         }
@@ -87,9 +92,9 @@ void incflo::compute_vel_forces_on_level (int lev,
                 {
                     Real rhoinv = 1.0/rho(i,j,k);
 
-                    AMREX_D_TERM(vel_f(i,j,k,0) = -(gradp(i,j,k,0)+l_gp0[0])*rhoinv + l_gravity[0];,
-                                 vel_f(i,j,k,1) = -(gradp(i,j,k,1)+l_gp0[1])*rhoinv + l_gravity[1];,
-                                 vel_f(i,j,k,2) = -(gradp(i,j,k,2)+l_gp0[2])*rhoinv + l_gravity[2];);
+                    AMREX_D_TERM(vel_f(i,j,k,0) = incflo_vel_force(i,j,k,0,rhoinv,gradp,l_gp0,l_gravity);,
+                                 vel_f(i,j,k,1) = incflo_vel_force(i,j,k,1,rhoinv,gradp,l_gp0,l_gravity);,
+                                 vel_f(i,j,k,2) = incflo_vel_force(i,j,k,2,rhoinv,gradp,l_gp0,l_gravity););
                 });
             }
     }
@@ -1,7 +1,131 @@
 #include <incflo.H>
 
+#include <algorithm>
+
 using namespace amrex;
 
+// Regrid all levels above lbase. Levels are remade as in AmrCore::regrid: when
+// their BoxArray changes or when that of the next coarser level changed. With
+// amr.regrid_keep_owners the new DistributionMapping of a changed level keeps the
+// boxes that persist on their old owner, so that their data is copied locally
+// rather than communicated.
+// overrides the virtual function in AmrCore
+void incflo::regrid (int lbase, Real time, bool /*initial*/)
+{
+    BL_PROFILE("incflo::regrid()");
+
+    if (lbase >= max_level) return;
+
+    int new_finest;
+    Vector<BoxArray> new_grids(finest_level+2);
+    MakeNewGrids(lbase, time, new_finest, new_grids);
+
+    bool coarse_ba_changed = false;
+    for (int lev = lbase+1; lev <= new_finest; ++lev)
+    {
+        if (lev <= finest_level)
+        {
+            const bool ba_changed = (new_grids[lev] != grids[lev]);
+            if (ba_changed or coarse_ba_changed)
+            {
+                BoxArray level_grids = grids[lev];
+                DistributionMapping level_dmap = dmap[lev];
+                if (ba_changed) {
+                    level_grids = new_grids[lev];
+                    level_dmap = make_regrid_dmap(lev, level_grids);
+                }
+                RemakeLevel(lev, time, level_grids, level_dmap);
+                SetBoxArray(lev, level_grids);
+                SetDistributionMap(lev, level_dmap);
+            }
+            coarse_ba_changed = ba_changed;
+        }
+        else
+        {
+            DistributionMapping new_dmap = make_regrid_dmap(lev, new_grids[lev]);
+            MakeNewLevelFromCoarse(lev, time, new_grids[lev], new_dmap);
+            SetBoxArray(lev, new_grids[lev]);
+            SetDistributionMap(lev, new_dmap);
+        }
+    }
+
+    for (int lev = new_finest+1; lev <= finest_level; ++lev)
+    {
+        ClearLevel(lev);
+        ClearBoxArray(lev);
+        ClearDistributionMap(lev);
+    }
+
+    finest_level = new_finest;
+}
+
+// Build the DistributionMapping for the new BoxArray ba of level lev. By default
+// this is the configured strategy (DistributionMapping::strategy). With
+// amr.regrid_keep_owners, boxes that are also in the current BoxArray keep their
+// owner and the new boxes are handed out, largest first, to the least loaded ranks.
+DistributionMapping incflo::make_regrid_dmap (int lev, BoxArray const& ba) const
+{
+#ifdef AMREX_USE_EB
+    // Reuse the mapping of a cached EB factory for the same grids so that
+    // make_factory can hand it back instead of building a new one
+    for (auto const& entry : m_factory_cache) {
+        auto const& fact = static_cast<EBFArrayBoxFactory const&>(*entry.second);
+        if (entry.first == lev and fact.boxArray() == ba) {
+            return fact.DistributionMap();
+        }
+    }
+#endif
+
+    if (!m_regrid_keep_owners or lev > finest_level) {
+        return DistributionMapping(ba);
+    }
+
+    BoxArray const& old_ba = grids[lev];
+    DistributionMapping const& old_dm = dmap[lev];
+    const int nprocs = ParallelDescriptor::NProcs();
+
+    Vector<int> pmap(ba.size(), -1);
+    Vector<Long> load(nprocs, 0);
+    Long kept_cells = 0;
+    for (int i = 0, N = ba.size(); i < N; ++i)
+    {
+        const Box& bx = ba[i];
+        for (auto const& is : old_ba.intersections(bx)) {
+            if (old_ba[is.first] == bx) {
+                pmap[i] = old_dm[is.first];
+                load[pmap[i]] += bx.numPts();
+                kept_cells += bx.numPts();
+                break;
+            }
+        }
+    }
+
+    Vector<int> new_boxes;
+    for (int i = 0, N = ba.size(); i < N; ++i) {
+        if (pmap[i] < 0) new_boxes.push_back(i);
+    }
+    std::stable_sort(new_boxes.begin(), new_boxes.end(),
+                     [&ba] (int a, int b) { return ba[a].numPts() > ba[b].numPts(); });
+    for (int i : new_boxes) {
+        const int iproc = static_cast<int>(std::min_element(load.begin(), load.end())
+                                           - load.begin());
+        pmap[i] = iproc;
+        load[iproc] += ba[i].numPts();
+    }
+
+    if (m_verbose > 0)
+    {
+        const Long max_load = *std::max_element(load.begin(), load.end());
+        const Real avg_load = Real(ba.numPts()) / nprocs;
+        amrex::Print() << "Regrid level " << lev << ": "
+                       << Real(100*kept_cells) / Real(ba.numPts())
+                       << "% of the cells kept on their owner, load imbalance (max/mean cells) "
+                       << Real(max_load) / avg_load << std::endl;
+    }
+
+    return DistributionMapping(pmap);
+}
+
 // Make a new level using provided BoxArray and DistributionMapping and
 // fill with interpolated coarse level data.
 // overrides the pure virtual function in AmrCore
@@ -16,15 +140,7 @@ void incflo::MakeNewLevelFromCoarse (int lev,
         amrex::Print() << "Making new level " << lev << " from coarse" << std::endl;
     }
 
-#ifdef AMREX_USE_EB
-    std::unique_ptr<FabFactory<FArrayBox> > new_fact = makeEBFabFactory(geom[lev], ba, dm,
-                                                                        {nghost_eb_basic(),
-                                                                         nghost_eb_volume(),
-                                                                         nghost_eb_full()},
-                                                                        EBSupport::full);
-#else
-    std::unique_ptr<FabFactory<FArrayBox> > new_fact(new FArrayBoxFactory());
-#endif
+    std::unique_ptr<FabFactory<FArrayBox> > new_fact = make_factory(lev, ba, dm);
     std::unique_ptr<LevelData> new_leveldata
         (new LevelData(ba, dm, *new_fact, m_ntrac, nghost_state(),
                        m_use_godunov,
@@ -39,11 +155,19 @@ void incflo::MakeNewLevelFromCoarse (int lev,
     fillcoarsepatch_gradp(lev, time, new_leveldata->gp, 0);
     new_leveldata->p.setVal(0.0);
 
+    if (m_stats_int > 0) {
+        MultiFab new_stats(ba, dm, nstats(), 0, MFInfo(), *new_fact);
+        fillcoarsepatch_stats(lev, time, new_stats, 0);
+        m_stats[lev] = std::move(new_stats);
+    }
+
     m_leveldata[lev] = std::move(new_leveldata);
+    cache_factory(lev, std::move(m_factory[lev]));
     m_factory[lev] = std::move(new_fact);
 
     m_diffusion_tensor_op.reset();
     m_diffusion_scalar_op.reset();
+    clear_diag_caches();
 }
 
 // Remake an existing level using provided BoxArray and DistributionMapping and
@@ -58,15 +182,7 @@ void incflo::RemakeLevel (int lev, Real time, const BoxArray& ba,
         amrex::Print() << "Remaking level " << lev << std::endl;
     }
 
-#ifdef AMREX_USE_EB
-    std::unique_ptr<FabFactory<FArrayBox> > new_fact = makeEBFabFactory(geom[lev], ba, dm,
-                                                                        {nghost_eb_basic(),
-                                                                         nghost_eb_volume(),
-                                                                         nghost_eb_full()},
-                                                                        EBSupport::full);
-#else
-    std::unique_ptr<FabFactory<FArrayBox> > new_fact(new FArrayBoxFactory());
-#endif
+    std::unique_ptr<FabFactory<FArrayBox> > new_fact = make_factory(lev, ba, dm);
     std::unique_ptr<LevelData> new_leveldata
         (new LevelData(ba, dm, *new_fact, m_ntrac, nghost_state(),
                        m_use_godunov,
@@ -81,11 +197,19 @@ void incflo::RemakeLevel (int lev, Real time, const BoxArray& ba,
     fillpatch_gradp(lev, time, new_leveldata->gp, 0);
     new_leveldata->p.setVal(0.0);
 
+    if (m_stats_int > 0) {
+        MultiFab new_stats(ba, dm, nstats(), 0, MFInfo(), *new_fact);
+        fillpatch_stats(lev, time, new_stats, 0);
+        m_stats[lev] = std::move(new_stats);
+    }
+
     m_leveldata[lev] = std::move(new_leveldata);
+    cache_factory(lev, std::move(m_factory[lev]));
     m_factory[lev] = std::move(new_fact);
 
     m_diffusion_tensor_op.reset();
     m_diffusion_scalar_op.reset();
+    clear_diag_caches();
 }
 
 // Delete level data
@@ -94,7 +218,72 @@ void incflo::ClearLevel (int lev)
 {
     BL_PROFILE("incflo::ClearLevel()");
     m_leveldata[lev].reset();
-    m_factory[lev].reset();
+    cache_factory(lev, std::move(m_factory[lev]));
+    if (m_stats_int > 0) m_stats[lev].clear();
     m_diffusion_tensor_op.reset();
     m_diffusion_scalar_op.reset();
+    clear_diag_caches();
+}
+
+// Return the EB factory for level lev on (ba,dm), taking it from the cache of
+// factories released by earlier regrids when the grids have been seen before.
+std::unique_ptr<FabFactory<FArrayBox> >
+incflo::make_factory (int lev, BoxArray const& ba, DistributionMapping const& dm)
+{
+#ifdef AMREX_USE_EB
+    for (auto it = m_factory_cache.begin(); it != m_factory_cache.end(); ++it)
+    {
+        auto const& fact = static_cast<EBFArrayBoxFactory const&>(*(it->second));
+        if (it->first == lev and fact.boxArray() == ba and fact.DistributionMap() == dm)
+        {
+            if (m_verbose > 0) {
+                amrex::Print() << "Reusing cached EB factory on level " << lev << std::endl;
+            }
+            std::unique_ptr<FabFactory<FArrayBox> > new_fact = std::move(it->second);
+            m_factory_cache.erase(it);
+            return new_fact;
+        }
+    }
+    return makeEBFabFactory(geom[lev], ba, dm,
+                            {nghost_eb_basic(),
+                             nghost_eb_volume(),
+                             nghost_eb_full()},
+                            EBSupport::full);
+#else
+    return std::unique_ptr<FabFactory<FArrayBox> >(new FArrayBoxFactory());
+#endif
+}
+
+// Keep a factory that is no longer used by level lev, dropping the oldest
+// entry once the cache holds m_eb_factory_cache_size factories.
+void incflo::cache_factory (int lev, std::unique_ptr<FabFactory<FArrayBox> >&& fact)
+{
+#ifdef AMREX_USE_EB
+    if (fact and m_eb_factory_cache_size > 0)
+    {
+        if (static_cast<int>(m_factory_cache.size()) >= m_eb_factory_cache_size) {
+            m_factory_cache.erase(m_factory_cache.begin());
+        }
+        m_factory_cache.emplace_back(lev, std::move(fact));
+    }
+#endif
+    fact.reset();
+}
+
+// Drop the diagnostics and redistribution data that depend on the grids; they are
+// rebuilt on first use
+void incflo::clear_diag_caches ()
+{
+    m_diag_masks.clear();
+    m_divu_linop.reset();
+#ifdef AMREX_USE_EB
+    m_eb_cut_cells.clear();
+    m_redist_vinv.clear();
+    m_srd_itracker.clear();
+    m_srd_data.clear();
+    m_eb_halo_grids.clear();
+    m_eb_halo_dmap.clear();
+    m_eb_halo_fact.clear();
+    m_eb_halo_index.clear();
+#endif
 }
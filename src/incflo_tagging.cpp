@@ -1,4 +1,5 @@
 #include <incflo.H>
+#include <derive_K.H>
 
 #ifdef AMREX_USE_EB
 #include <AMReX_EBAmrUtil.H>
@@ -6,42 +7,66 @@
 
 using namespace amrex;
 
-// tag cells for refinement
-// overrides the pure virtual function in AmrCore
-void incflo::ErrorEst (int lev, TagBoxArray& tags, Real time, int ngrow)
+namespace {
+
+// Read a per-level threshold; the last value given is used for all finer levels
+void read_tag_threshold (ParmParse& pp, std::string const& name, Vector<Real>& v, int max_level)
 {
-    BL_PROFILE("incflo::ErrorEst()");
+    pp.queryarr(name.c_str(), v);
+    if (v.size() > 0) {
+        Real last = v.back();
+        v.resize(max_level+1, last);
+    }
+}
 
-    static bool first = true;
-    static Vector<Real> rhoerr_v, gradrhoerr_v;
+// Largest one-sided undivided difference of component n around (i,j,k),
+// ignoring neighbours that are not connected to the cell
+AMREX_GPU_DEVICE AMREX_FORCE_INLINE
+Real max_undivided_diff (int i, int j, int k, int n, Array4<Real const> const& q,
+                         GpuArray<bool,2*AMREX_SPACEDIM> const& conn) noexcept
+{
+    const Real q0 = q(i,j,k,n);
+    Real d = 0.0;
+    if (conn[0]) d = amrex::max(d, amrex::Math::abs(q0 - q(i-1,j,k,n)));
+    if (conn[1]) d = amrex::max(d, amrex::Math::abs(q(i+1,j,k,n) - q0));
+    if (conn[2]) d = amrex::max(d, amrex::Math::abs(q0 - q(i,j-1,k,n)));
+    if (conn[3]) d = amrex::max(d, amrex::Math::abs(q(i,j+1,k,n) - q0));
+#if (AMREX_SPACEDIM == 3)
+    if (conn[4]) d = amrex::max(d, amrex::Math::abs(q0 - q(i,j,k-1,n)));
+    if (conn[5]) d = amrex::max(d, amrex::Math::abs(q(i,j,k+1,n) - q0));
+#endif
+    return d;
+}
 
-    static bool tag_region;
+}
 
-    if (first) {
-        first = false;
-        ParmParse pp("incflo");
+// Read the refinement criteria once; ErrorEst only looks them up per level
+void incflo::ReadTaggingParameters ()
+{
+    ParmParse pp("incflo");
 
-        pp.queryarr("rhoerr", rhoerr_v);
-        if (rhoerr_v.size() > 0) {
-            Real last = rhoerr_v.back();
-            rhoerr_v.resize(max_level+1, last);
-        }
+    read_tag_threshold(pp, "rhoerr"       , m_rhoerr       , max_level);
+    read_tag_threshold(pp, "gradrhoerr"   , m_gradrhoerr   , max_level);
+    read_tag_threshold(pp, "vorterr"      , m_vorterr      , max_level);
+    read_tag_threshold(pp, "gradvelerr"   , m_gradvelerr   , max_level);
+    read_tag_threshold(pp, "strainrateerr", m_strainrateerr, max_level);
+    read_tag_threshold(pp, "qcriterr"     , m_qcriterr     , max_level);
+    read_tag_threshold(pp, "gradtracerr"  , m_gradtracerr  , max_level);
 
-        pp.queryarr("gradrhoerr", gradrhoerr_v);
-        if (gradrhoerr_v.size() > 0) {
-            Real last = gradrhoerr_v.back();
-            gradrhoerr_v.resize(max_level+1, last);
-        }
+    tag_region_lo.resize(AMREX_SPACEDIM);
+    tag_region_hi.resize(AMREX_SPACEDIM);
 
-        tag_region_lo.resize(3);
-        tag_region_hi.resize(3);
+    pp.query("tag_region", m_tag_region);
 
-        tag_region = false;
-        pp.query("tag_region", tag_region);
+    pp.queryarr("tag_region_lo", tag_region_lo);
+    pp.queryarr("tag_region_hi", tag_region_hi);
+}
 
-        pp.queryarr("tag_region_lo", tag_region_lo);
-        pp.queryarr("tag_region_hi", tag_region_hi);
-    }
+// tag cells for refinement
+// overrides the pure virtual function in AmrCore
+void incflo::ErrorEst (int lev, TagBoxArray& tags, Real time, int ngrow)
+{
+    BL_PROFILE("incflo::ErrorEst()");
 
     const auto   tagval = TagBox::SET;
 //    const auto clearval = TagBox::CLEAR;
@@ -51,19 +76,56 @@ void incflo::ErrorEst (int lev, TagBoxArray& tags, Real time, int ngrow)
     auto const& flags = factory.getMultiEBCellFlagFab();
 #endif
 
-//    const auto prob_lo = geom[lev].ProbLoArray();
-
-    bool tag_rho = lev < rhoerr_v.size();
-    bool tag_gradrho = lev < gradrhoerr_v.size();
+    const bool tag_rho       = lev < m_rhoerr.size();
+    const bool tag_gradrho   = lev < m_gradrhoerr.size();
+    const bool tag_vort      = lev < m_vorterr.size();
+    const bool tag_gradvel   = lev < m_gradvelerr.size();
+    const bool tag_strain    = lev < m_strainrateerr.size();
+    const bool tag_qcrit     = lev < m_qcriterr.size();
+    const bool tag_gradtrac  = lev < m_gradtracerr.size() and m_ntrac > 0;
+    const bool tag_velderiv  = tag_vort or tag_strain or tag_qcrit;
+    const bool tag_region    = m_tag_region;
+
+    const Real big = std::numeric_limits<Real>::max();
+    const Real rhoerr       = tag_rho      ? m_rhoerr[lev]        : big;
+    const Real gradrhoerr   = tag_gradrho  ? m_gradrhoerr[lev]    : big;
+    const Real vorterr      = tag_vort     ? m_vorterr[lev]       : big;
+    const Real gradvelerr   = tag_gradvel  ? m_gradvelerr[lev]    : big;
+    const Real strainrateerr= tag_strain   ? m_strainrateerr[lev] : big;
+    const Real qcriterr     = tag_qcrit    ? m_qcriterr[lev]      : big;
+    const Real gradtracerr  = tag_gradtrac ? m_gradtracerr[lev]   : big;
+
+    if (!(tag_rho or tag_gradrho or tag_velderiv or tag_gradvel or tag_gradtrac or tag_region)) {
+#ifdef AMREX_USE_EB
+        if (m_refine_cutcells) {
+            amrex::TagCutCells(tags, m_leveldata[lev]->velocity);
+        }
+#endif
+        return;
+    }
 
+    // Only fill the ghost cells needed by the criteria in use
     if (tag_gradrho) {
         fillpatch_density(lev, time, m_leveldata[lev]->density, 1);
     }
+    if (tag_velderiv or tag_gradvel) {
+        fillpatch_velocity(lev, time, m_leveldata[lev]->velocity, 1);
+    }
+    if (tag_gradtrac) {
+        fillpatch_tracer(lev, time, m_leveldata[lev]->tracer, 1);
+    }
 
-    const Real l_dx = geom[lev].CellSize(0);
-    const Real l_dy = geom[lev].CellSize(1);
-    const Real l_dz = geom[lev].CellSize(2);
+    const auto problo = geom[lev].ProbLoArray();
+    const auto dx     = geom[lev].CellSizeArray();
+    const auto dxinv  = geom[lev].InvCellSizeArray();
+    GpuArray<Real,AMREX_SPACEDIM> rlo, rhi;
+    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+        rlo[idim] = tag_region ? tag_region_lo[idim] : 0.0;
+        rhi[idim] = tag_region ? tag_region_hi[idim] : 0.0;
+    }
+    const int ntrac = m_ntrac;
 
+    // All criteria are evaluated in a single pass over each tile
 #ifdef _OPENMP
 #pragma omp parallel if (Gpu::notInLaunchRegion())
 #endif
@@ -72,66 +134,89 @@ void incflo::ErrorEst (int lev, TagBoxArray& tags, Real time, int ngrow)
         Box const& bx = mfi.tilebox();
         auto const& tag = tags.array(mfi);
 
-        if (tag_rho or tag_gradrho) 
+        Array4<Real const> const& rho = m_leveldata[lev]->density.const_array(mfi);
+        Array4<Real const> const& vel = m_leveldata[lev]->velocity.const_array(mfi);
+        Array4<Real const> const& tra = (ntrac > 0) ? m_leveldata[lev]->tracer.const_array(mfi)
+                                                    : Array4<Real const>{};
+#ifdef AMREX_USE_EB
+        auto const& flagfab = flags[mfi];
+        if (flagfab.getType(bx) == FabType::covered) continue;
+        Array4<EBCellFlag const> const& flag = flagfab.const_array();
+#endif
+
+        amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
         {
-            Array4<Real const> const& rho = m_leveldata[lev]->density.const_array(mfi);
-            Real rhoerr = tag_rho ? rhoerr_v[lev]: std::numeric_limits<Real>::max();
-            Real gradrhoerr = tag_gradrho ? gradrhoerr_v[lev] : std::numeric_limits<Real>::max();
-            amrex::ParallelFor(bx,
-            [tag_rho,tag_gradrho,rhoerr,gradrhoerr,tagval,rho,tag]
-            AMREX_GPU_DEVICE (int i, int j, int k) noexcept
-            {
-                if (tag_rho and rho(i,j,k) > rhoerr) {
+            if (tag_region) {
+                const IntVect iv(AMREX_D_DECL(i,j,k));
+                bool inside = true;
+                for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+                    const Real x = problo[idim] + (iv[idim]+0.5)*dx[idim];
+                    inside = inside and x >= rlo[idim] and x <= rhi[idim];
+                }
+                // Tag if we are inside the specified box
+                if (inside) {
                     tag(i,j,k) = tagval;
+                    return;
                 }
-                if (tag_gradrho) {
-                    Real ax = amrex::Math::abs(rho(i+1,j,k) - rho(i,j,k));
-                    Real ay = amrex::Math::abs(rho(i,j+1,k) - rho(i,j,k));
-                    ax = amrex::max(ax,amrex::Math::abs(rho(i,j,k) - rho(i-1,j,k)));
-                    ay = amrex::max(ay,amrex::Math::abs(rho(i,j,k) - rho(i,j-1,k)));
-#if (AMREX_SPACEDIM == 2)
-                    if (amrex::max(ax,ay) >= gradrhoerr) {
-                        tag(i,j,k) = tagval;
-                    }
-#elif (AMREX_SPACEDIM == 3)
-                    Real az = amrex::Math::abs(rho(i,j,k+1) - rho(i,j,k));
-                    az = amrex::max(az,amrex::Math::abs(rho(i,j,k) - rho(i,j,k-1)));
-                    if (amrex::max(ax,ay,az) >= gradrhoerr) {
-                        tag(i,j,k) = tagval;
-                    }
+            }
+
+            GpuArray<bool,2*AMREX_SPACEDIM> conn;
+#ifdef AMREX_USE_EB
+            const EBCellFlag fl = flag(i,j,k);
+            if (fl.isCovered()) return;
+            AMREX_D_TERM(conn[0] = fl.isConnected(-1,0,0); conn[1] = fl.isConnected(1,0,0);,
+                         conn[2] = fl.isConnected(0,-1,0); conn[3] = fl.isConnected(0,1,0);,
+                         conn[4] = fl.isConnected(0,0,-1); conn[5] = fl.isConnected(0,0,1););
+#else
+            for (auto& c : conn) c = true;
 #endif
+
+            bool t = tag_rho and rho(i,j,k) > rhoerr;
+
+            if (!t and tag_gradrho) {
+                t = max_undivided_diff(i,j,k,0,rho,conn) >= gradrhoerr;
+            }
+
+            if (!t and tag_gradvel) {
+                for (int n = 0; n < AMREX_SPACEDIM and !t; ++n) {
+                    t = max_undivided_diff(i,j,k,n,vel,conn) >= gradvelerr;
+                }
+            }
+
+            if (!t and tag_gradtrac) {
+                for (int n = 0; n < ntrac and !t; ++n) {
+                    t = max_undivided_diff(i,j,k,n,tra,conn) >= gradtracerr;
                 }
-            });
-        } 
- 
-        if (tag_region) {
-
-            Real xlo = tag_region_lo[0];
-            Real ylo = tag_region_lo[1];
-            Real zlo = tag_region_lo[2];
-            Real xhi = tag_region_hi[0];
-            Real yhi = tag_region_hi[1];
-            Real zhi = tag_region_hi[2];
-
-            amrex::ParallelFor(bx,
-            [xlo, xhi, ylo, yhi, zlo, zhi, l_dx, l_dy, l_dz,tagval, tag]
-            AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+            }
+
+            if (!t and tag_velderiv)
             {
-                 Real x = (i+0.5)*l_dx;
-                 Real y = (j+0.5)*l_dy;
-                 Real z = (k+0.5)*l_dz;
+                Real g[AMREX_SPACEDIM][AMREX_SPACEDIM];
+                incflo_velocity_gradient(i,j,k,vel,dxinv,conn,g);
+
+                // S_ij S_ij and W_ij W_ij of the strain rate and rotation tensors
+                Real ss = 0.0, ww = 0.0;
+                for (int a = 0; a < AMREX_SPACEDIM; ++a) {
+                    for (int b = 0; b < AMREX_SPACEDIM; ++b) {
+                        const Real s = 0.5*(g[a][b] + g[b][a]);
+                        const Real w = 0.5*(g[a][b] - g[b][a]);
+                        ss += s*s;
+                        ww += w*w;
+                    }
+                }
 
-                 // Tag if we are inside the specified box
-                 if (x >= xlo && x <= xhi && y >= ylo && y <= yhi && z >= zlo && z <= zhi)
-                 {
-                    tag(i,j,k) = tagval;
-                 }
-            });
-        } 
+                t = (tag_vort   and std::sqrt(2.0*ww) >= vorterr) or
+                    (tag_strain and std::sqrt(2.0*ss) >= strainrateerr) or
+                    (tag_qcrit  and 0.5*(ww - ss) >= qcriterr);
+            }
+
+            if (t) {
+                tag(i,j,k) = tagval;
+            }
+        });
     }
 
 #ifdef AMREX_USE_EB
-    m_refine_cutcells = true;
     // Refine on cut cells
     if (m_refine_cutcells)
     {
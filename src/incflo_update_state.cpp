@@ -0,0 +1,282 @@
+#include <incflo.H>
+#include <incflo_forces_K.H>
+
+using namespace amrex;
+
+//
+// Explicit update of the state in the predictor and the corrector:
+//
+//   Predictor:
+//
+//     rho^*      = rho^n + dt * R_r^n
+//     (rho s)^*  = (rho s)^n + dt * ( R_t^n + rho^nph f_s + a L_s^n )
+//     u^*        = u^n + dt * ( R_u^n - grad(p + p0) / rho^nph + g + a divtau^n )
+//
+//   Corrector:
+//
+//     rho^n+1    = rho^n + dt/2 * ( R_r^n + R_r^* )
+//     (rho s)^n+1= (rho s)^n + dt * ( (R_t^n + R_t^*)/2 + rho^nph f_s + (L_s^n + b L_s^*)/2 )
+//     u^n+1      = u^n + dt * ( (R_u^n + R_u^*)/2 - grad(p + p0) / rho^nph + g
+//                                                 + (divtau^n + b divtau^*)/2 )
+//
+// with a = 1, b = 1 for explicit and a = 1/2, b = 0 for Crank-Nicolson diffusion. With
+// implicit diffusion the explicit diffusive terms are dropped, except for the lagged
+// tensor correction held in divtau^n (predictor) or divtau^* (corrector).
+//
+// update_state does all of this in a single pass over each tile. It is instantiated
+// for every combination of the diffusion type and the tensor correction, tracer and
+// constant-density flags, so that each instance is a tight loop without runtime
+// checks. The instances used for this run are selected once by select_update_kernels.
+//
+// Without UpdateVelocity only density and tracers are updated and update_velocity
+// does the velocity with the forcing from compute_vel_forces; this is needed with
+// Boussinesq, where the forcing depends on the diffused tracer.
+//
+
+namespace {
+
+// Which explicit diffusion terms enter the update, and with which weight
+template <bool Corrector, incflo::DiffusionType DiffType, bool TensorCorrection>
+struct UpdateTerms
+{
+    static constexpr bool is_explicit = (DiffType == incflo::DiffusionType::Explicit);
+    static constexpr bool is_implicit = (DiffType == incflo::DiffusionType::Implicit);
+
+    static constexpr bool laps_o   = !is_implicit;
+    static constexpr bool laps     = Corrector and is_explicit;
+    static constexpr bool divtau_o = !is_implicit or (!Corrector and TensorCorrection);
+    static constexpr bool divtau   = Corrector and (is_explicit or TensorCorrection);
+
+    // Weight of the old-time terms; the new-time terms are weighted by half with
+    // explicit diffusion and fully for the tensor correction
+    static constexpr Real w_old = (Corrector or !(is_explicit or is_implicit)) ? 0.5 : 1.0;
+    static constexpr Real w_new = is_explicit ? 0.5 : 1.0;
+};
+
+template <bool C, incflo::DiffusionType D, bool TC, bool AT, bool CD>
+incflo::UpdateStateFn select_state_by_velocity (bool uv)
+{
+    return uv ? &incflo::update_state<C,D,TC,AT,CD,true>
+              : &incflo::update_state<C,D,TC,AT,CD,false>;
+}
+
+template <bool C, incflo::DiffusionType D, bool TC, bool AT>
+incflo::UpdateStateFn select_state_by_density (bool cd, bool uv)
+{
+    return cd ? select_state_by_velocity<C,D,TC,AT,true >(uv)
+              : select_state_by_velocity<C,D,TC,AT,false>(uv);
+}
+
+template <bool C, incflo::DiffusionType D, bool TC>
+incflo::UpdateStateFn select_state_by_tracer (bool at, bool cd, bool uv)
+{
+    return at ? select_state_by_density<C,D,TC,true >(cd, uv)
+              : select_state_by_density<C,D,TC,false>(cd, uv);
+}
+
+template <bool C>
+void select_for_phase (incflo::DiffusionType diff_type, bool tc, bool at, bool cd, bool uv,
+                       incflo::UpdateStateFn& state_fn, incflo::UpdateVelocityFn& vel_fn)
+{
+    using DT = incflo::DiffusionType;
+    switch (diff_type)
+    {
+    case DT::Explicit:
+        state_fn = select_state_by_tracer<C,DT::Explicit,false>(at, cd, uv);
+        vel_fn   = &incflo::update_velocity<C,DT::Explicit,false>;
+        break;
+    case DT::Crank_Nicolson:
+        state_fn = select_state_by_tracer<C,DT::Crank_Nicolson,false>(at, cd, uv);
+        vel_fn   = &incflo::update_velocity<C,DT::Crank_Nicolson,false>;
+        break;
+    case DT::Implicit:
+        if (tc) {
+            state_fn = select_state_by_tracer<C,DT::Implicit,true>(at, cd, uv);
+            vel_fn   = &incflo::update_velocity<C,DT::Implicit,true>;
+        } else {
+            state_fn = select_state_by_tracer<C,DT::Implicit,false>(at, cd, uv);
+            vel_fn   = &incflo::update_velocity<C,DT::Implicit,false>;
+        }
+        break;
+    default:
+        amrex::Abort("select_update_kernels: unknown diffusion type");
+    }
+}
+
+}
+
+void incflo::select_update_kernels ()
+{
+    // The velocity forcing with Boussinesq uses the tracer after its diffusion solve
+    m_fuse_velocity_update = !m_use_boussinesq;
+
+    // The tensor correction is only allowed with implicit diffusion (see ReadParameters)
+    const bool tc = use_tensor_correction and m_diff_type == DiffusionType::Implicit;
+
+    select_for_phase<false>(m_diff_type, tc, m_advect_tracer, m_constant_density,
+                            m_fuse_velocity_update,
+                            m_predictor_update_state, m_predictor_update_velocity);
+    select_for_phase<true >(m_diff_type, tc, m_advect_tracer, m_constant_density,
+                            m_fuse_velocity_update,
+                            m_corrector_update_state, m_corrector_update_velocity);
+}
+
+template <bool Corrector, incflo::DiffusionType DiffType, bool TensorCorrection,
+          bool AdvectTracer, bool ConstantDensity, bool UpdateVelocity>
+void incflo::update_state (Vector<MultiFab>& density_nph,
+                           Vector<MultiFab> const& tra_forces)
+{
+    BL_PROFILE("incflo::update_state");
+
+    using Terms = UpdateTerms<Corrector,DiffType,TensorCorrection>;
+
+    const Real l_dt = m_dt;
+    const int l_ntrac = m_ntrac;
+    GpuArray<Real,3> l_gravity{m_gravity[0],m_gravity[1],m_gravity[2]};
+    GpuArray<Real,3> l_gp0{m_gp0[0], m_gp0[1], m_gp0[2]};
+
+    // With constant density rho^nph = rho^n, including the ghost cells the caller asked for
+    if (ConstantDensity) {
+        for (int lev = 0; lev <= finest_level; lev++) {
+            MultiFab::Copy(density_nph[lev], m_leveldata[lev]->density_o, 0, 0, 1,
+                           density_nph[lev].nGrow());
+        }
+    }
+
+#ifdef _OPENMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+    for (int lev = 0; lev <= finest_level; lev++)
+    {
+        auto& ld = *m_leveldata[lev];
+        for (MFIter mfi(ld.velocity,TilingIfNotGPU()); mfi.isValid(); ++mfi)
+        {
+            Box const& bx = mfi.tilebox();
+            Array4<Real const> const& rho_o   = ld.density_o.const_array(mfi);
+            Array4<Real      > const& rho_new = ld.density.array(mfi);
+            Array4<Real      > const& rho_nph = density_nph[lev].array(mfi);
+            Array4<Real const> const& drdt_o  = ld.conv_density_o.const_array(mfi);
+            Array4<Real const> const& drdt    = (Corrector and !ConstantDensity)
+                ? ld.conv_density.const_array(mfi) : Array4<Real const>{};
+
+            Array4<Real const> const& tra_o   = (AdvectTracer) ? ld.tracer_o.const_array(mfi)
+                                                               : Array4<Real const>{};
+            Array4<Real      > const& tra     = (AdvectTracer) ? ld.tracer.array(mfi)
+                                                               : Array4<Real>{};
+            Array4<Real const> const& tra_f   = (AdvectTracer) ? tra_forces[lev].const_array(mfi)
+                                                               : Array4<Real const>{};
+            Array4<Real const> const& dtdt_o  = (AdvectTracer) ? ld.conv_tracer_o.const_array(mfi)
+                                                               : Array4<Real const>{};
+            Array4<Real const> const& dtdt    = (AdvectTracer and Corrector)
+                ? ld.conv_tracer.const_array(mfi) : Array4<Real const>{};
+            Array4<Real const> const& laps_o  = (AdvectTracer and Terms::laps_o)
+                ? ld.laps_o.const_array(mfi) : Array4<Real const>{};
+            Array4<Real const> const& laps    = (AdvectTracer and Terms::laps)
+                ? ld.laps.const_array(mfi) : Array4<Real const>{};
+
+            Array4<Real      > const& vel      = (UpdateVelocity) ? ld.velocity.array(mfi)
+                                                                  : Array4<Real>{};
+            Array4<Real const> const& vel_o    = (UpdateVelocity) ? ld.velocity_o.const_array(mfi)
+                                                                  : Array4<Real const>{};
+            Array4<Real const> const& gradp    = (UpdateVelocity) ? ld.gp.const_array(mfi)
+                                                                  : Array4<Real const>{};
+            Array4<Real const> const& dvdt_o   = (UpdateVelocity) ? ld.conv_velocity_o.const_array(mfi)
+                                                                  : Array4<Real const>{};
+            Array4<Real const> const& dvdt     = (UpdateVelocity and Corrector)
+                ? ld.conv_velocity.const_array(mfi) : Array4<Real const>{};
+            Array4<Real const> const& divtau_o = (UpdateVelocity and Terms::divtau_o)
+                ? ld.divtau_o.const_array(mfi) : Array4<Real const>{};
+            Array4<Real const> const& divtau   = (UpdateVelocity and Terms::divtau)
+                ? ld.divtau.const_array(mfi) : Array4<Real const>{};
+
+            amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+            {
+                const Real rho_old = rho_o(i,j,k);
+                Real rho  = rho_old;
+                Real rhoh = rho_old;
+                if (!ConstantDensity)
+                {
+                    const Real dr = (Corrector) ? 0.5*(drdt_o(i,j,k) + drdt(i,j,k)) : drdt_o(i,j,k);
+                    rho  = rho_old + l_dt * dr;
+                    rhoh = 0.5 * (rho_old + rho);
+                    rho_nph(i,j,k) = rhoh;
+                    rho_new(i,j,k) = rho;
+                }
+
+                // (rho trac)^new = (rho trac)^old + dt * (
+                //                   div(rho trac u) + div (mu grad trac) + rho * f_t )
+                if (AdvectTracer)
+                {
+                    for (int n = 0; n < l_ntrac; ++n)
+                    {
+                        Real rhs = (Corrector) ? 0.5*(dtdt_o(i,j,k,n) + dtdt(i,j,k,n)) : dtdt_o(i,j,k,n);
+                        rhs += rhoh * tra_f(i,j,k,n);
+                        if (Terms::laps_o) rhs += Terms::w_old * laps_o(i,j,k,n);
+                        if (Terms::laps  ) rhs += Terms::w_new * laps  (i,j,k,n);
+                        tra(i,j,k,n) = (rho_old*tra_o(i,j,k,n) + l_dt * rhs) / rho;
+                    }
+                }
+
+                // Same forcing as compute_vel_forces_on_level without Boussinesq
+                if (UpdateVelocity)
+                {
+                    const Real rhoinv = 1.0/rhoh;
+                    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim)
+                    {
+                        Real rhs = (Corrector) ? 0.5*(dvdt_o(i,j,k,idim) + dvdt(i,j,k,idim))
+                                               : dvdt_o(i,j,k,idim);
+                        rhs += incflo_vel_force(i,j,k,idim,rhoinv,gradp,l_gp0,l_gravity);
+                        if (Terms::divtau_o) rhs += Terms::w_old * divtau_o(i,j,k,idim);
+                        if (Terms::divtau  ) rhs += Terms::w_new * divtau  (i,j,k,idim);
+                        vel(i,j,k,idim) = vel_o(i,j,k,idim) + l_dt * rhs;
+                    }
+                }
+            });
+        } // mfi
+    } // lev
+}
+
+template <bool Corrector, incflo::DiffusionType DiffType, bool TensorCorrection>
+void incflo::update_velocity (Vector<MultiFab> const& vel_forces)
+{
+    BL_PROFILE("incflo::update_velocity");
+
+    using Terms = UpdateTerms<Corrector,DiffType,TensorCorrection>;
+
+    const Real l_dt = m_dt;
+
+#ifdef _OPENMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+    for (int lev = 0; lev <= finest_level; lev++)
+    {
+        auto& ld = *m_leveldata[lev];
+        for (MFIter mfi(ld.velocity,TilingIfNotGPU()); mfi.isValid(); ++mfi)
+        {
+            Box const& bx = mfi.tilebox();
+            Array4<Real      > const& vel      = ld.velocity.array(mfi);
+            Array4<Real const> const& vel_o    = ld.velocity_o.const_array(mfi);
+            Array4<Real const> const& vel_f    = vel_forces[lev].const_array(mfi);
+            Array4<Real const> const& dvdt_o   = ld.conv_velocity_o.const_array(mfi);
+            Array4<Real const> const& dvdt     = (Corrector) ? ld.conv_velocity.const_array(mfi)
+                                                             : Array4<Real const>{};
+            Array4<Real const> const& divtau_o = (Terms::divtau_o) ? ld.divtau_o.const_array(mfi)
+                                                                   : Array4<Real const>{};
+            Array4<Real const> const& divtau   = (Terms::divtau) ? ld.divtau.const_array(mfi)
+                                                                 : Array4<Real const>{};
+
+            amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+            {
+                for (int idim = 0; idim < AMREX_SPACEDIM; ++idim)
+                {
+                    Real rhs = (Corrector) ? 0.5*(dvdt_o(i,j,k,idim) + dvdt(i,j,k,idim))
+                                           : dvdt_o(i,j,k,idim);
+                    rhs += vel_f(i,j,k,idim);
+                    if (Terms::divtau_o) rhs += Terms::w_old * divtau_o(i,j,k,idim);
+                    if (Terms::divtau  ) rhs += Terms::w_new * divtau  (i,j,k,idim);
+                    vel(i,j,k,idim) = vel_o(i,j,k,idim) + l_dt * rhs;
+                }
+            });
+        } // mfi
+    } // lev
+}
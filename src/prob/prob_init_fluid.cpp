@@ -216,7 +216,7 @@ void incflo::init_rayleigh_taylor (Box const& vbx, Box const& gbx,
         Real x = problo[0] + (i+0.5)*dx[0];
         Real y = problo[1] + (j+0.5)*dx[1];
 
-        const Real r2d = amrex::min(std::abs(x-splitx), 0.5*L_x);
+        const Real r2d = amrex::min(std::abs(x-splitx), half*L_x);
         const Real pertheight = 0.5 - 0.01*std::cos(2.0*pi*r2d/L_x);
 
         density(i,j,k) = rho_1 + ((rho_2-rho_1)/2.0)*(1.0+std::tanh((y-pertheight)/width));
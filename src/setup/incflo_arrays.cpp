@@ -55,4 +55,6 @@ void incflo::ResizeArrays ()
     m_leveldata.resize(max_level+1);
 
     m_factory.resize(max_level+1);
+
+    m_stats.resize(max_level+1);
 }
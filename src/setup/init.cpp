@@ -22,8 +22,17 @@ void incflo::ReadParameters ()
  	ParmParse pp("amr");
 
 	pp.query("regrid_int", m_regrid_int);
+        pp.query("regrid_adaptive", m_regrid_adaptive);
+
+        // By default regrid once features may have crossed the error buffer
+        int n_error_buf = 1;
+        pp.query("n_error_buf", n_error_buf);
+        m_regrid_buffer_cells = n_error_buf;
+        pp.query("regrid_buffer_cells", m_regrid_buffer_cells);
+        pp.query("regrid_keep_owners", m_regrid_keep_owners);
 #ifdef AMREX_USE_EB
         pp.query("refine_cutcells", m_refine_cutcells);
+        pp.query("eb_factory_cache_size", m_eb_factory_cache_size);
 #endif
 
         pp.query("KE_int", m_KE_int);
@@ -36,6 +45,10 @@ void incflo::ReadParameters ()
         pp.query("verbose", m_verbose);
 
 	pp.query("steady_state_tol", m_steady_state_tol);
+        pp.query("steady_state_int", m_steady_state_int);
+        if (m_steady_state_int <= 0) {
+            amrex::Abort("We require incflo.steady_state_int > 0");
+        }
         pp.query("initial_iterations", m_initial_iterations);
         pp.query("do_initial_proj", m_do_initial_proj);
 
@@ -64,6 +77,26 @@ void incflo::ReadParameters ()
 
         if (!m_use_godunov) m_godunov_include_diff_in_forcing = false;
 
+#ifdef AMREX_USE_EB
+        std::string redistribution_weight = "volume";
+        pp.query("redistribution_weight", redistribution_weight);
+        if (redistribution_weight == "density") {
+            m_redist_density_weighted = true;
+        } else if (redistribution_weight != "volume") {
+            amrex::Abort("incflo.redistribution_weight must be volume or density");
+        }
+
+        std::string redistribution_type = "FluxRedist";
+        pp.query("redistribution_type", redistribution_type);
+        if (redistribution_type == "StateRedist") {
+            m_state_redist = true;
+        } else if (redistribution_type != "FluxRedist") {
+            amrex::Abort("incflo.redistribution_type must be FluxRedist or StateRedist");
+        }
+
+        pp.query("eb_local_halo", m_eb_local_halo);
+#endif
+
         // The default for diffusion_type is 2, i.e. the default m_diff_type is DiffusionType::Implicit
         int diffusion_type = 2;
         pp.query("diffusion_type", diffusion_type);
@@ -145,6 +178,11 @@ void incflo::ReadParameters ()
         pp_nodal.query( "mg_rtol"                , m_nodal_mg_rtol );
         pp_nodal.query( "mg_atol"                , m_nodal_mg_atol );
     } // end prefix nodal
+
+    // This needs m_ntrac so must come after the incflo prefix
+    ReadDiagParameters();
+    ReadStatsParameters();
+    ReadTaggingParameters();
 }
 
 void incflo::ReadIOParameters()
@@ -155,6 +193,7 @@ void incflo::ReadIOParameters()
     pp.query("check_file", m_check_file);
     pp.query("check_int", m_check_int);
     pp.query("restart", m_restart_file);
+    pp.query("restart_mmap", m_restart_mmap);
 
     pp.query("plotfile_on_restart", m_plotfile_on_restart);
 
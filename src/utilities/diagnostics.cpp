@@ -7,39 +7,42 @@ using namespace amrex;
 //
 void incflo::PrintMaxValues(Real time_in)
 {
-    return; // xxxxx TODO
+    BL_PROFILE("incflo::PrintMaxValues()");
 
-#if 0
-    ComputeDivU(time_in);
+    Vector<MultiFab> divu(finest_level+1);
+    for (int lev = 0; lev <= finest_level; ++lev) {
+        divu[lev].define(grids[lev], dmap[lev], 1, 0, MFInfo(), Factory(lev));
+    }
+    ComputeDivU(GetVecOfPtrs(divu), time_in);
 
     for(int lev = 0; lev <= finest_level; lev++)
     {
         amrex::Print() << "Level " << lev << std::endl;
-        PrintMaxVel(lev);
+        PrintMaxVel(lev, divu[lev]);
         PrintMaxGp(lev);
     }
     amrex::Print() << std::endl;
-#endif
 }
 
 //
-// Print the maximum values of the velocity components and velocity divergence
+// Print the maximum values of the velocity components and the max and L2 norms
+// of the velocity divergence
 //
-void incflo::PrintMaxVel(int lev)
+void incflo::PrintMaxVel(int lev, MultiFab const& divu)
 {
-#if 0
-    // xxxxx TODO
-    amrex::Print() << "max(abs(u/v/w/divu))  = "
-                   << Norm(vel , lev, 0, 0) << "  "
-		   << Norm(vel , lev, 1, 0) << "  "
-                   << Norm(vel , lev, 2, 0) << "  "
-                   << Norm(divu, lev, 0, 0) << "  " << std::endl;
-    if (ntrac > 0)
-    {
-       for (int i = 0; i < ntrac; i++)
-          amrex::Print() << "max tracer" << i << " = " << Norm(tracer,lev,i,0) << std::endl;;
+    auto const& ld = *m_leveldata[lev];
+    const Real dv = AMREX_D_TERM(geom[lev].CellSize(0),*geom[lev].CellSize(1),*geom[lev].CellSize(2));
+
+    amrex::Print() << "max(abs(u/v/w))  = ";
+    for (int n = 0; n < AMREX_SPACEDIM; ++n) {
+        amrex::Print() << ld.velocity.norm0(n) << "  ";
+    }
+    amrex::Print() << std::endl;
+    amrex::Print() << "max(abs(divu)), L2(divu)  = "
+                   << divu.norm0(0) << "  " << divu.norm2(0)*std::sqrt(dv) << std::endl;
+    for (int i = 0; i < m_ntrac; i++) {
+        amrex::Print() << "max tracer" << i << " = " << ld.tracer.norm0(i) << std::endl;
     }
-#endif
 }
 
 //
@@ -47,14 +50,13 @@ void incflo::PrintMaxVel(int lev)
 //
 void incflo::PrintMaxGp(int lev)
 {
-#if 0
-    // xxxxx TODO
-    amrex::Print() << "max(abs(gpx/gpy/gpz/p))  = "
-                   << Norm(gp, lev, 0, 0) << "  "
-		   << Norm(gp, lev, 1, 0) << "  "
-                   << Norm(gp, lev, 2, 0) << "  "
-		   << Norm(p , lev, 0, 0) << "  " << std::endl;
-#endif
+    auto const& ld = *m_leveldata[lev];
+
+    amrex::Print() << "max(abs(gpx/gpy/gpz/p))  = ";
+    for (int n = 0; n < AMREX_SPACEDIM; ++n) {
+        amrex::Print() << ld.gp.norm0(n) << "  ";
+    }
+    amrex::Print() << ld.p.norm0(0) << std::endl;
 }
 
 void incflo::CheckForNans(int lev)
@@ -0,0 +1,164 @@
+#include <AMReX_FPC.H>
+#include <AMReX_VisMF.H>
+#include <incflo.H>
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <map>
+#include <sstream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace amrex;
+
+namespace {
+
+//
+// Parse the "FAB ((...),(...))box ncomp" line that VisMF::Header::Version_v1
+// writes in front of each FAB and check that the data that follows it is in
+// the native real format, i.e. can be copied without conversion.
+//
+bool parse_fab_header (const char* p, std::size_t avail, std::size_t& hdrlen,
+                       Box& bx, int& ncomp)
+{
+    const char* nl = static_cast<const char*>(std::memchr(p, '\n', avail));
+    if (nl == nullptr) return false;
+    hdrlen = nl - p + 1;
+
+    std::string line(p, nl);
+    if (line.compare(0, 4, "FAB ") != 0) return false;
+    const auto rd_end = line.find(")))");
+    if (rd_end == std::string::npos) return false;
+
+    // The real descriptor is written as ((nfmt, (fmt...)),(nord, (ord...)))
+    std::string rd = line.substr(4, rd_end-1);
+    for (auto& c : rd) {
+        if (!std::isdigit(static_cast<unsigned char>(c))) c = ' ';
+    }
+    std::istringstream rds(rd);
+    int nfmt, nord;
+    rds >> nfmt;
+    Vector<long> fmt(std::max(nfmt,0));
+    for (auto& f : fmt) rds >> f;
+    rds >> nord;
+    Vector<int> ord(std::max(nord,0));
+    for (auto& o : ord) rds >> o;
+    if (!rds) return false;
+
+    const RealDescriptor& native = FPC::NativeRealDescriptor();
+    if (fmt != native.formatarray() or ord != native.orderarray()) return false;
+
+    std::istringstream bs(line.substr(rd_end+3));
+    bs >> bx >> ncomp;
+    return !bs.fail();
+}
+
+//
+// Read the local FABs of mf straight out of memory-mapped VisMF data files.
+// Returns false if the data cannot be used as is, in which case the caller
+// falls back to VisMF::Read.
+//
+bool mmap_read (MultiFab& mf, std::string const& name)
+{
+    Vector<char> hdr_chars;
+    ParallelDescriptor::ReadAndBcastFile(name + "_H", hdr_chars);
+    std::istringstream hdr_is(std::string(hdr_chars.dataPtr()), std::istringstream::in);
+
+    VisMF::Header hdr;
+    hdr_is >> hdr;
+
+    const bool has_fab_header = (hdr.m_vers == VisMF::Header::Version_v1);
+    if (!has_fab_header and !(hdr.m_writtenRD == FPC::NativeRealDescriptor())) return false;
+    if (hdr.m_ncomp != mf.nComp() or hdr.m_ngrow != mf.nGrowVect() or
+        hdr.m_ba != mf.boxArray()) {
+        return false;
+    }
+
+    // Group the local FABs by data file so that each file is mapped once,
+    // and visit them in file order
+    std::map<std::string, Vector<std::pair<Long,int> > > fabs_in_file;
+    for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
+        auto const& fod = hdr.m_fod[mfi.index()];
+        fabs_in_file[fod.m_name].push_back({fod.m_head, mfi.index()});
+    }
+
+    const std::string dir = VisMF::DirName(name);
+    const int ncomp = mf.nComp();
+    for (auto& kv : fabs_in_file)
+    {
+        std::sort(kv.second.begin(), kv.second.end());
+
+        const std::string fname = dir + kv.first;
+        int fd = ::open(fname.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (::fstat(fd, &st) != 0) { ::close(fd); return false; }
+        const std::size_t fsize = st.st_size;
+        void* addr = ::mmap(nullptr, fsize, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (addr == MAP_FAILED) return false;
+        ::madvise(addr, fsize, MADV_SEQUENTIAL);
+
+        bool ok = true;
+        for (auto const& head_index : kv.second)
+        {
+            FArrayBox& fab = mf[head_index.second];
+            const std::size_t nbytes = fab.box().numPts() * ncomp * sizeof(Real);
+
+            std::size_t offset = head_index.first;
+            if (has_fab_header) {
+                std::size_t hdrlen;
+                Box bx;
+                int nc;
+                ok = offset < fsize and
+                    parse_fab_header(static_cast<const char*>(addr)+offset, fsize-offset,
+                                     hdrlen, bx, nc) and
+                    bx == fab.box() and nc == ncomp;
+                offset += hdrlen;
+            }
+            ok = ok and offset + nbytes <= fsize;
+            if (!ok) break;
+
+#ifdef AMREX_USE_GPU
+            Gpu::htod_memcpy
+#else
+            std::memcpy
+#endif
+                (fab.dataPtr(), static_cast<const char*>(addr)+offset, nbytes);
+        }
+
+        ::munmap(addr, fsize);
+        if (!ok) return false;
+    }
+    return true;
+}
+
+}
+
+//
+// Read a checkpointed MultiFab, by default through VisMF::Read. With amr.restart_mmap
+// the data files are memory-mapped and copied directly into the FABs when they were
+// written in the native real format for the same BoxArray and number of ghost cells.
+//
+void incflo::ReadCheckpointMultiFab (MultiFab& mf, std::string const& name) const
+{
+    BL_PROFILE("incflo::ReadCheckpointMultiFab()");
+
+    bool done = false;
+    if (m_restart_mmap)
+    {
+        done = mmap_read(mf, name);
+        ParallelDescriptor::ReduceBoolAnd(done);
+        if (!done and m_verbose > 0) {
+            amrex::Print() << "Falling back to VisMF::Read for " << name << std::endl;
+        }
+    }
+
+    if (!done) {
+        VisMF::Read(mf, name);
+    }
+}
@@ -0,0 +1,471 @@
+#include <AMReX_Utility.H>
+#include <incflo.H>
+
+#include <fstream>
+#include <limits>
+
+using namespace amrex;
+
+namespace {
+
+//
+// Map a diagnostic variable name (velx, vely, velz, gpx, gpy, gpz, density, tracerN)
+// onto the LevelData member that holds it and the component within that MultiFab.
+//
+enum struct DiagField { velocity, gradp, density, tracer, invalid };
+
+DiagField parse_diag_var (std::string const& name, int ntrac, int& comp)
+{
+    const std::string dirs{"xyz"};
+    comp = 0;
+    if (name.size() == 4 and name.compare(0,3,"vel") == 0) {
+        comp = static_cast<int>(dirs.find(name[3]));
+        return (comp >= 0 and comp < AMREX_SPACEDIM) ? DiagField::velocity : DiagField::invalid;
+    } else if (name.size() == 3 and name.compare(0,2,"gp") == 0) {
+        comp = static_cast<int>(dirs.find(name[2]));
+        return (comp >= 0 and comp < AMREX_SPACEDIM) ? DiagField::gradp : DiagField::invalid;
+    } else if (name == "density") {
+        return DiagField::density;
+    } else if (name.size() > 6 and name.compare(0,6,"tracer") == 0) {
+        if (name.find_first_not_of("0123456789",6) != std::string::npos) return DiagField::invalid;
+        comp = std::stoi(name.substr(6));
+        return (comp < ntrac) ? DiagField::tracer : DiagField::invalid;
+    }
+    return DiagField::invalid;
+}
+
+void check_diag_vars (Vector<std::string> const& names, int ntrac, std::string const& param)
+{
+    for (auto const& name : names) {
+        int comp;
+        if (parse_diag_var(name, ntrac, comp) == DiagField::invalid) {
+            amrex::Abort("diag." + param + ": unknown variable " + name);
+        }
+    }
+}
+
+// Open a time series file for appending; the header is only written when the file is new
+void open_diag_file (std::ofstream& ofs, std::string const& fname, std::string const& header)
+{
+    bool is_new = !amrex::FileExists(fname);
+    ofs.open(fname.c_str(), std::ios::out | std::ios::app);
+    if (!ofs.good()) {
+        amrex::FileOpenFailed(fname);
+    }
+    ofs.precision(12);
+    if (is_new) {
+        ofs << header << "\n";
+    }
+}
+
+}
+
+void incflo::ReadDiagParameters ()
+{
+    ParmParse pp("diag");
+
+    pp.query("int", m_diag_int);
+    pp.query("file", m_diag_file);
+
+    pp.queryarr("sum_vars", m_diag_sum_vars);
+    pp.queryarr("minmax_vars", m_diag_minmax_vars);
+    pp.queryarr("plane_avg_vars", m_diag_plane_vars);
+    pp.query("plane_avg_dir", m_diag_plane_dir);
+    pp.query("plane_avg_lev", m_diag_plane_lev);
+    pp.queryarr("probe_vars", m_diag_probe_vars);
+    pp.queryarr("probe_locs", m_diag_probe_locs);
+    pp.query("tracer_mass", m_diag_tracer_mass);
+    pp.query("eb_forces", m_diag_eb_forces);
+    pp.queryarr("torque_center", m_diag_torque_center);
+
+    check_diag_vars(m_diag_sum_vars, m_ntrac, "sum_vars");
+    check_diag_vars(m_diag_minmax_vars, m_ntrac, "minmax_vars");
+    check_diag_vars(m_diag_plane_vars, m_ntrac, "plane_avg_vars");
+    check_diag_vars(m_diag_probe_vars, m_ntrac, "probe_vars");
+
+    if (m_diag_plane_dir < 0 or m_diag_plane_dir >= AMREX_SPACEDIM) {
+        amrex::Abort("diag.plane_avg_dir must be between 0 and AMREX_SPACEDIM-1");
+    }
+    if (m_diag_probe_locs.size() % AMREX_SPACEDIM != 0) {
+        amrex::Abort("diag.probe_locs must contain AMREX_SPACEDIM coordinates per probe");
+    }
+    if (m_diag_torque_center.size() != AMREX_SPACEDIM) {
+        amrex::Abort("diag.torque_center must contain AMREX_SPACEDIM coordinates");
+    }
+#ifndef AMREX_USE_EB
+    if (m_diag_eb_forces) {
+        amrex::Abort("diag.eb_forces requires a build with embedded boundaries");
+    }
+#endif
+}
+
+MultiFab const&
+incflo::get_diag_var (int lev, std::string const& name, int& comp) const
+{
+    auto const& ld = *m_leveldata[lev];
+    switch (parse_diag_var(name, m_ntrac, comp))
+    {
+    case DiagField::velocity: return ld.velocity;
+    case DiagField::gradp:    return ld.gp;
+    case DiagField::density:  return ld.density;
+    case DiagField::tracer:   return ld.tracer;
+    default:
+        amrex::Abort("get_diag_var: unknown variable " + name);
+    };
+    return ld.velocity;
+}
+
+//
+// Masks that are 1 on cells not covered by the next finer level and 0 elsewhere.
+//
+Vector<iMultiFab> incflo::make_diag_masks () const
+{
+    Vector<iMultiFab> masks(finest_level+1);
+    for (int lev = 0; lev <= finest_level; ++lev) {
+        if (lev < finest_level) {
+            masks[lev] = amrex::makeFineMask(grids[lev], dmap[lev], grids[lev+1],
+                                             refRatio(lev), 1, 0);
+        } else {
+            masks[lev].define(grids[lev], dmap[lev], 1, 0);
+            masks[lev].setVal(1);
+        }
+    }
+    return masks;
+}
+
+// The masks of the current grids, built on first use after a regrid
+Vector<iMultiFab> const& incflo::diag_masks ()
+{
+    if (m_diag_masks.size() != finest_level+1) {
+        m_diag_masks = make_diag_masks();
+    }
+    return m_diag_masks;
+}
+
+//
+// Local (not yet reduced over ranks) value of int( rho^p * q dV ) on the uncovered
+// part of level lev, where rho is only used if non-null. The sum is accumulated in
+// double so that conservation checks stay meaningful in single-precision builds.
+//
+double incflo::diag_volume_sum (int lev, MultiFab const& mf, int comp, MultiFab const* rho,
+                              iMultiFab const& mask) const
+{
+    const Real dv = AMREX_D_TERM(geom[lev].CellSize(0),*geom[lev].CellSize(1),*geom[lev].CellSize(2));
+    const bool has_rho = (rho != nullptr);
+
+    ReduceOps<ReduceOpSum> reduce_op;
+    ReduceData<double> reduce_data(reduce_op);
+    using ReduceTuple = typename decltype(reduce_data)::Type;
+
+    for (MFIter mfi(mf,TilingIfNotGPU()); mfi.isValid(); ++mfi)
+    {
+        Box const& bx = mfi.tilebox();
+        Array4<Real const> const& q = mf.const_array(mfi);
+        Array4<int const> const& msk = mask.const_array(mfi);
+        Array4<Real const> const& r = (has_rho) ? rho->const_array(mfi) : Array4<Real const>{};
+#ifdef AMREX_USE_EB
+        Array4<Real const> const& vfrac = EBFactory(lev).getVolFrac().const_array(mfi);
+#endif
+        reduce_op.eval(bx, reduce_data,
+        [=] AMREX_GPU_DEVICE (int i, int j, int k) -> ReduceTuple
+        {
+            Real w = msk(i,j,k);
+#ifdef AMREX_USE_EB
+            w *= vfrac(i,j,k);
+#endif
+            if (has_rho) w *= r(i,j,k);
+            return { static_cast<double>(w) * q(i,j,k,comp) };
+        });
+    }
+
+    return amrex::get<0>(reduce_data.value()) * dv;
+}
+
+//
+// Horizontal average of ncomp components of mf over planes normal to dir on level lev.
+// The returned vector is ordered as (plane index, component) and is identical on all ranks.
+//
+Vector<Real> incflo::PlaneAverage (int lev, int dir, MultiFab const& mf, int comp, int ncomp) const
+{
+    BL_PROFILE("incflo::PlaneAverage()");
+
+    Box const& domain = geom[lev].Domain();
+    const int lo = domain.smallEnd(dir);
+    const int nplanes = domain.length(dir);
+
+    // The last slot of each plane holds the (volume-fraction weighted) cell count.
+    // The sums are kept in double, also in single-precision builds.
+    const int nslots = ncomp+1;
+    Gpu::DeviceVector<double> psum_d(nplanes*nslots, 0.0);
+    double* psum = psum_d.data();
+
+    for (MFIter mfi(mf); mfi.isValid(); ++mfi)
+    {
+        Box const& bx = mfi.validbox();
+        Array4<Real const> const& q = mf.const_array(mfi);
+#ifdef AMREX_USE_EB
+        Array4<Real const> const& vfrac = EBFactory(lev).getVolFrac().const_array(mfi);
+#endif
+        amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+        {
+            const int ip = ((dir == 0) ? i : ((dir == 1) ? j : k)) - lo;
+#ifdef AMREX_USE_EB
+            const Real w = vfrac(i,j,k);
+#else
+            const Real w = 1.0;
+#endif
+            for (int n = 0; n < ncomp; ++n) {
+                Gpu::Atomic::Add(&psum[ip*nslots+n], static_cast<double>(w*q(i,j,k,comp+n)));
+            }
+            Gpu::Atomic::Add(&psum[ip*nslots+ncomp], static_cast<double>(w));
+        });
+    }
+
+    Vector<double> psum_h(nplanes*nslots);
+    Gpu::copy(Gpu::deviceToHost, psum_d.begin(), psum_d.end(), psum_h.begin());
+
+    ParallelAllReduce::Sum(psum_h.data(), psum_h.size(), ParallelContext::CommunicatorSub());
+
+    Vector<Real> avg(nplanes*ncomp, 0.0);
+    for (int ip = 0; ip < nplanes; ++ip) {
+        const double vol = psum_h[ip*nslots+ncomp];
+        if (vol > 0.0) {
+            for (int n = 0; n < ncomp; ++n) {
+                avg[ip*ncomp+n] = psum_h[ip*nslots+n] / vol;
+            }
+        }
+    }
+    return avg;
+}
+
+//
+// Compute the reductions requested with the diag.* inputs and append one line per
+// reduction type to the corresponding time series file.
+//
+void incflo::WriteReducedDiagnostics ()
+{
+    BL_PROFILE("incflo::WriteReducedDiagnostics()");
+
+    const bool do_sums = !m_diag_sum_vars.empty() or m_diag_tracer_mass;
+    const bool do_minmax = !m_diag_minmax_vars.empty();
+    const int ntrac_mass = (m_diag_tracer_mass) ? m_ntrac : 0;
+
+    // *************************************************************************************
+    // Volume integrals and min/max over the uncovered part of each level
+    // *************************************************************************************
+    Vector<double> sums(m_diag_sum_vars.size()+ntrac_mass, 0.0);
+    Vector<Real> mins(m_diag_minmax_vars.size(),  std::numeric_limits<Real>::max());
+    Vector<Real> maxs(m_diag_minmax_vars.size(), std::numeric_limits<Real>::lowest());
+
+    if (do_sums or do_minmax)
+    {
+        Vector<iMultiFab> const& masks = diag_masks();
+
+        for (int lev = 0; lev <= finest_level; ++lev)
+        {
+            for (int iv = 0; iv < m_diag_sum_vars.size(); ++iv) {
+                int comp;
+                MultiFab const& mf = get_diag_var(lev, m_diag_sum_vars[iv], comp);
+                sums[iv] += diag_volume_sum(lev, mf, comp, nullptr, masks[lev]);
+            }
+            for (int n = 0; n < ntrac_mass; ++n) {
+                sums[m_diag_sum_vars.size()+n] +=
+                    diag_volume_sum(lev, m_leveldata[lev]->tracer, n,
+                                    &(m_leveldata[lev]->density), masks[lev]);
+            }
+
+            for (int iv = 0; iv < m_diag_minmax_vars.size(); ++iv)
+            {
+                int comp;
+                MultiFab const& mf = get_diag_var(lev, m_diag_minmax_vars[iv], comp);
+
+                ReduceOps<ReduceOpMin,ReduceOpMax> reduce_op;
+                ReduceData<Real,Real> reduce_data(reduce_op);
+                using ReduceTuple = typename decltype(reduce_data)::Type;
+
+                for (MFIter mfi(mf,TilingIfNotGPU()); mfi.isValid(); ++mfi)
+                {
+                    Box const& bx = mfi.tilebox();
+                    Array4<Real const> const& q = mf.const_array(mfi);
+                    Array4<int const> const& msk = masks[lev].const_array(mfi);
+#ifdef AMREX_USE_EB
+                    Array4<Real const> const& vfrac = EBFactory(lev).getVolFrac().const_array(mfi);
+#endif
+                    reduce_op.eval(bx, reduce_data,
+                    [=] AMREX_GPU_DEVICE (int i, int j, int k) -> ReduceTuple
+                    {
+                        bool valid = msk(i,j,k);
+#ifdef AMREX_USE_EB
+                        valid = valid and vfrac(i,j,k) > 0.0;
+#endif
+                        if (valid) {
+                            return { q(i,j,k,comp), q(i,j,k,comp) };
+                        } else {
+                            return { std::numeric_limits<Real>::max(),
+                                     std::numeric_limits<Real>::lowest() };
+                        }
+                    });
+                }
+
+                auto hv = reduce_data.value();
+                mins[iv] = amrex::min(mins[iv], amrex::get<0>(hv));
+                maxs[iv] = amrex::max(maxs[iv], amrex::get<1>(hv));
+            }
+        }
+
+        const int ioproc = ParallelDescriptor::IOProcessorNumber();
+        if (do_sums) {
+            ParallelReduce::Sum(sums.data(), sums.size(), ioproc,
+                                ParallelContext::CommunicatorSub());
+        }
+        if (do_minmax) {
+            ParallelDescriptor::ReduceRealMin(mins.data(), mins.size(), ioproc);
+            ParallelDescriptor::ReduceRealMax(maxs.data(), maxs.size(), ioproc);
+        }
+    }
+
+    // *************************************************************************************
+    // Plane averages on a single level
+    // *************************************************************************************
+    const int plane_lev = amrex::min(m_diag_plane_lev, finest_level);
+    Vector<Vector<Real> > plane_avg;
+    for (auto const& name : m_diag_plane_vars) {
+        int comp;
+        MultiFab const& mf = get_diag_var(plane_lev, name, comp);
+        plane_avg.push_back(PlaneAverage(plane_lev, m_diag_plane_dir, mf, comp, 1));
+    }
+
+    // *************************************************************************************
+    // Point probes, sampled on the finest level that contains each probe
+    // *************************************************************************************
+    const int nprobes = m_diag_probe_locs.size() / AMREX_SPACEDIM;
+    Vector<Real> probes(nprobes*m_diag_probe_vars.size(), 0.0);
+    if (!probes.empty())
+    {
+        ReduceOps<ReduceOpSum> reduce_op;
+        for (int ip = 0; ip < nprobes; ++ip)
+        {
+            int probe_lev = -1;
+            IntVect iv;
+            for (int lev = finest_level; lev >= 0 and probe_lev < 0; --lev) {
+                const auto problo = geom[lev].ProbLoArray();
+                const auto dxinv = geom[lev].InvCellSizeArray();
+                for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+                    iv[idim] = static_cast<int>(std::floor((m_diag_probe_locs[ip*AMREX_SPACEDIM+idim]
+                                                            - problo[idim]) * dxinv[idim]));
+                }
+                if (grids[lev].contains(iv)) probe_lev = lev;
+            }
+            if (probe_lev < 0) continue;
+
+            const Box pbx(iv,iv);
+            for (int iv_var = 0; iv_var < m_diag_probe_vars.size(); ++iv_var)
+            {
+                int comp;
+                MultiFab const& mf = get_diag_var(probe_lev, m_diag_probe_vars[iv_var], comp);
+
+                ReduceData<Real> reduce_data(reduce_op);
+                using ReduceTuple = typename decltype(reduce_data)::Type;
+                for (MFIter mfi(mf); mfi.isValid(); ++mfi)
+                {
+                    Box const& bx = mfi.validbox() & pbx;
+                    if (bx.ok()) {
+                        Array4<Real const> const& q = mf.const_array(mfi);
+                        reduce_op.eval(bx, reduce_data,
+                        [=] AMREX_GPU_DEVICE (int i, int j, int k) -> ReduceTuple
+                        {
+                            return { q(i,j,k,comp) };
+                        });
+                    }
+                }
+                probes[ip*m_diag_probe_vars.size()+iv_var] = amrex::get<0>(reduce_data.value());
+            }
+        }
+        ParallelDescriptor::ReduceRealSum(probes.data(), probes.size(),
+                                          ParallelDescriptor::IOProcessorNumber());
+    }
+
+    // *************************************************************************************
+    // Force and torque on the embedded boundary
+    // *************************************************************************************
+    Vector<double> eb_forces;
+    if (m_diag_eb_forces) {
+        eb_forces = ComputeEBForces(m_cur_time);
+    }
+
+    // *************************************************************************************
+    // Append to the time series files
+    // *************************************************************************************
+    if (ParallelDescriptor::IOProcessor())
+    {
+        if (do_sums) {
+            std::string header = "step,time";
+            for (auto const& name : m_diag_sum_vars) header += ",int_" + name;
+            for (int n = 0; n < ntrac_mass; ++n) header += ",mass_tracer" + std::to_string(n);
+
+            std::ofstream ofs;
+            open_diag_file(ofs, m_diag_file + "_integrals.csv", header);
+            ofs << m_nstep << "," << m_cur_time;
+            for (auto s : sums) ofs << "," << s;
+            ofs << "\n";
+        }
+
+        if (do_minmax) {
+            std::string header = "step,time";
+            for (auto const& name : m_diag_minmax_vars) header += ",min_" + name + ",max_" + name;
+
+            std::ofstream ofs;
+            open_diag_file(ofs, m_diag_file + "_minmax.csv", header);
+            ofs << m_nstep << "," << m_cur_time;
+            for (int iv = 0; iv < mins.size(); ++iv) ofs << "," << mins[iv] << "," << maxs[iv];
+            ofs << "\n";
+        }
+
+        // One line per plane: step, time, plane index, cell-center coordinate, averages
+        if (!plane_avg.empty()) {
+            std::string header = "step,time,plane,coord";
+            for (auto const& name : m_diag_plane_vars) header += ",avg_" + name;
+
+            std::ofstream ofs;
+            open_diag_file(ofs, m_diag_file + "_plane_avg.csv", header);
+            const int nplanes = geom[plane_lev].Domain().length(m_diag_plane_dir);
+            const Real dx = geom[plane_lev].CellSize(m_diag_plane_dir);
+            const Real lo = geom[plane_lev].ProbLo(m_diag_plane_dir);
+            for (int ip = 0; ip < nplanes; ++ip) {
+                ofs << m_nstep << "," << m_cur_time << "," << ip << "," << lo + (ip+0.5)*dx;
+                for (auto const& avg : plane_avg) ofs << "," << avg[ip];
+                ofs << "\n";
+            }
+        }
+
+        if (!eb_forces.empty()) {
+#if (AMREX_SPACEDIM == 3)
+            std::ofstream ofs;
+            open_diag_file(ofs, m_diag_file + "_eb_forces.csv", "step,time,Fx,Fy,Fz,Tx,Ty,Tz");
+            ofs << m_nstep << "," << m_cur_time;
+            for (int n = 0; n < 6; ++n) ofs << "," << eb_forces[n];
+#else
+            std::ofstream ofs;
+            open_diag_file(ofs, m_diag_file + "_eb_forces.csv", "step,time,Fx,Fy,Tz");
+            ofs << m_nstep << "," << m_cur_time << "," << eb_forces[0] << ","
+                << eb_forces[1] << "," << eb_forces[5];
+#endif
+            ofs << "\n";
+        }
+
+        if (!probes.empty()) {
+            std::string header = "step,time";
+            for (int ip = 0; ip < nprobes; ++ip) {
+                for (auto const& name : m_diag_probe_vars) {
+                    header += ",probe" + std::to_string(ip) + "_" + name;
+                }
+            }
+
+            std::ofstream ofs;
+            open_diag_file(ofs, m_diag_file + "_probes.csv", header);
+            ofs << m_nstep << "," << m_cur_time;
+            for (auto p : probes) ofs << "," << p;
+            ofs << "\n";
+        }
+    }
+}
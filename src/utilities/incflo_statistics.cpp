@@ -0,0 +1,146 @@
+#include <AMReX_ParmParse.H>
+#include <AMReX_Utility.H>
+#include <incflo.H>
+
+#include <fstream>
+
+using namespace amrex;
+
+//
+// Running time averages are stored in m_stats[lev] with the components
+//
+//   [0, SPACEDIM)                       <u_i>
+//   [SPACEDIM, SPACEDIM+ntrac)          <s_n>
+//   next SPACEDIM*(SPACEDIM+1)/2        <u_i u_j> for i <= j (uu, uv, uw, vv, vw, ww)
+//   last ntrac                          <s_n s_n>
+//
+// so that the Reynolds stresses and tracer variances can be formed from the
+// plane averages of these moments without keeping any plotfiles around.
+//
+
+void incflo::ReadStatsParameters ()
+{
+    ParmParse pp("stats");
+
+    pp.query("int", m_stats_int);
+    pp.query("file", m_stats_file);
+    pp.query("start_time", m_stats_start_time);
+    pp.query("plane_avg_dir", m_stats_plane_dir);
+    pp.query("plane_avg_lev", m_stats_plane_lev);
+
+    if (m_stats_plane_dir < 0 or m_stats_plane_dir >= AMREX_SPACEDIM) {
+        amrex::Abort("stats.plane_avg_dir must be between 0 and AMREX_SPACEDIM-1");
+    }
+}
+
+//
+// Blend the current velocity and tracer fields into the running averages,
+// weighting this step by dt relative to the time already averaged over.
+//
+void incflo::UpdateStatistics (Real dt)
+{
+    BL_PROFILE("incflo::UpdateStatistics()");
+
+    const Real wold = m_stats_time / (m_stats_time + dt);
+    const Real wnew = dt / (m_stats_time + dt);
+    const int ntrac = m_ntrac;
+    const int icomp_uu = AMREX_SPACEDIM + ntrac;
+    const int icomp_ss = icomp_uu + AMREX_SPACEDIM*(AMREX_SPACEDIM+1)/2;
+
+    for (int lev = 0; lev <= finest_level; ++lev)
+    {
+        MultiFab& stats = m_stats[lev];
+        auto const& ld = *m_leveldata[lev];
+#ifdef _OPENMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+        for (MFIter mfi(stats,TilingIfNotGPU()); mfi.isValid(); ++mfi)
+        {
+            Box const& bx = mfi.tilebox();
+            Array4<Real> const& s = stats.array(mfi);
+            Array4<Real const> const& vel = ld.velocity.const_array(mfi);
+            Array4<Real const> const& tra = (ntrac > 0) ? ld.tracer.const_array(mfi)
+                                                        : Array4<Real const>{};
+            amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+            {
+                int m = icomp_uu;
+                for (int a = 0; a < AMREX_SPACEDIM; ++a) {
+                    s(i,j,k,a) = wold*s(i,j,k,a) + wnew*vel(i,j,k,a);
+                    for (int b = a; b < AMREX_SPACEDIM; ++b) {
+                        s(i,j,k,m) = wold*s(i,j,k,m) + wnew*vel(i,j,k,a)*vel(i,j,k,b);
+                        ++m;
+                    }
+                }
+                for (int n = 0; n < ntrac; ++n) {
+                    const Real t = tra(i,j,k,n);
+                    s(i,j,k,AMREX_SPACEDIM+n) = wold*s(i,j,k,AMREX_SPACEDIM+n) + wnew*t;
+                    s(i,j,k,icomp_ss+n) = wold*s(i,j,k,icomp_ss+n) + wnew*t*t;
+                }
+            });
+        }
+    }
+
+    m_stats_time += dt;
+}
+
+//
+// Write the plane-averaged mean, Reynolds stress and tracer variance profiles
+// to <stats.file>NNNNN.csv, one line per plane.
+//
+void incflo::WriteStatistics () const
+{
+    BL_PROFILE("incflo::WriteStatistics()");
+
+    const int lev = amrex::min(m_stats_plane_lev, finest_level);
+    const int dir = m_stats_plane_dir;
+    const int ncomp = nstats();
+    const int icomp_uu = AMREX_SPACEDIM + m_ntrac;
+    const int icomp_ss = icomp_uu + AMREX_SPACEDIM*(AMREX_SPACEDIM+1)/2;
+
+    Vector<Real> avg = PlaneAverage(lev, dir, m_stats[lev], 0, ncomp);
+
+    if (ParallelDescriptor::IOProcessor())
+    {
+        const std::string names{"uvw"};
+        std::string fname = amrex::Concatenate(m_stats_file, m_nstep) + ".csv";
+        std::ofstream ofs(fname.c_str(), std::ios::out | std::ios::trunc);
+        if (!ofs.good()) {
+            amrex::FileOpenFailed(fname);
+        }
+        ofs.precision(12);
+
+        ofs << "# time = " << m_cur_time << ", averaging time = " << m_stats_time << "\n";
+        ofs << "coord";
+        for (int a = 0; a < AMREX_SPACEDIM; ++a) ofs << ",mean_" << names[a];
+        for (int n = 0; n < m_ntrac; ++n) ofs << ",mean_tracer" << n;
+        for (int a = 0; a < AMREX_SPACEDIM; ++a) {
+            for (int b = a; b < AMREX_SPACEDIM; ++b) {
+                ofs << ",R_" << names[a] << names[b];
+            }
+        }
+        for (int n = 0; n < m_ntrac; ++n) ofs << ",var_tracer" << n;
+        ofs << "\n";
+
+        const int nplanes = geom[lev].Domain().length(dir);
+        const Real dx = geom[lev].CellSize(dir);
+        const Real lo = geom[lev].ProbLo(dir);
+        for (int ip = 0; ip < nplanes; ++ip)
+        {
+            const Real* p = &avg[ip*ncomp];
+            ofs << lo + (ip+0.5)*dx;
+            for (int n = 0; n < icomp_uu; ++n) ofs << "," << p[n];
+            int m = icomp_uu;
+            for (int a = 0; a < AMREX_SPACEDIM; ++a) {
+                for (int b = a; b < AMREX_SPACEDIM; ++b) {
+                    ofs << "," << p[m] - p[a]*p[b];
+                    ++m;
+                }
+            }
+            for (int n = 0; n < m_ntrac; ++n) {
+                const Real mean = p[AMREX_SPACEDIM+n];
+                ofs << "," << p[icomp_ss+n] - mean*mean;
+            }
+            ofs << "\n";
+        }
+    }
+}
@@ -15,73 +15,108 @@ using namespace amrex;
 //      sum(abs( v^(n+1) - v^(n) )) / sum(abs( v^(n) )) < tol
 //      sum(abs( w^(n+1) - w^(n) )) / sum(abs( w^(n) )) < tol
 //
+// The check is only made every incflo.steady_state_int steps. On each level a
+// single pass over velocity and velocity_o gives the max change and, per component,
+// the sums of |u - uo| and |uo|; the results of all levels are reduced together.
+//
 bool incflo::SteadyStateReached()
 {
-
-    amrex::Abort("xxxxx TODO: SteadyStateReached");
-    return false;
-#if 0
     BL_PROFILE("incflo::SteadyStateReached()");
 
-    int condition1[finest_level + 1];
-    int condition2[finest_level + 1];
+    // Always return negative to first access. This way
+    // initial zero velocity field do not test for false positive
+    if (m_nstep < 2 or m_nstep % m_steady_state_int != 0) {
+        return false;
+    }
 
-    // Make sure velocity is up to date
-    incflo_set_velocity_bcs(m_cur_time, vel);
+    // For each level max |u-uo| over all components, and sum |u-uo| and sum |uo|
+    // for each component. The sums are kept in double, also in single precision.
+    const int nsums = 2*AMREX_SPACEDIM;
+    Vector<double> maxs(finest_level+1, 0.0);
+    Vector<double> sums(nsums*(finest_level+1), 0.0);
 
-    // Use temporaries to store the difference between current and previous solution
-    Vector<std::unique_ptr<MultiFab>> diff_vel;
-    diff_vel.resize(finest_level + 1);
-    for(int lev = 0; lev <= finest_level; lev++)
+    for (int lev = 0; lev <= finest_level; lev++)
     {
-#ifdef AMREX_USE_EB
-        diff_vel[lev].reset(new MultiFab(grids[lev], dmap[lev], AMREX_SPACEDIM, 0, MFInfo(), *ebfactory[lev]));
+        auto const& ld = *m_leveldata[lev];
+
+#if (AMREX_SPACEDIM == 3)
+        ReduceOps<ReduceOpMax,ReduceOpSum,ReduceOpSum,ReduceOpSum,
+                  ReduceOpSum,ReduceOpSum,ReduceOpSum> reduce_op;
+        ReduceData<double,double,double,double,double,double,double> reduce_data(reduce_op);
 #else
-        diff_vel[lev].reset(new MultiFab(grids[lev], dmap[lev], AMREX_SPACEDIM, 0, MFInfo()));
+        ReduceOps<ReduceOpMax,ReduceOpSum,ReduceOpSum,ReduceOpSum,ReduceOpSum> reduce_op;
+        ReduceData<double,double,double,double,double> reduce_data(reduce_op);
 #endif
-        MultiFab::LinComb(*diff_vel[lev], 1.0, *vel[lev], 0, -1.0, *vel_o[lev], 0, 0, AMREX_SPACEDIM, 0);
+        using ReduceTuple = typename decltype(reduce_data)::Type;
 
-        Real max_change = 0.0;
-        Real max_relchange = 0.0;
-        // Loop over components, only need to check the largest one
-        for(int i = 0; i < AMREX_SPACEDIM; i++)
+        for (MFIter mfi(ld.velocity,TilingIfNotGPU()); mfi.isValid(); ++mfi)
         {
-            // max(abs(u^{n+1}-u^n))
-            max_change = amrex::max(max_change, Norm(diff_vel, lev, i, 0));
+            Box const& bx = mfi.tilebox();
+            Array4<Real const> const& u  = ld.velocity.const_array(mfi);
+            Array4<Real const> const& uo = ld.velocity_o.const_array(mfi);
+            reduce_op.eval(bx, reduce_data,
+            [=] AMREX_GPU_DEVICE (int i, int j, int k) -> ReduceTuple
+            {
+                AMREX_D_TERM(const double du = amrex::Math::abs(u(i,j,k,0) - uo(i,j,k,0));,
+                             const double dv = amrex::Math::abs(u(i,j,k,1) - uo(i,j,k,1));,
+                             const double dw = amrex::Math::abs(u(i,j,k,2) - uo(i,j,k,2)););
+#if (AMREX_SPACEDIM == 3)
+                return { amrex::max(du,amrex::max(dv,dw)),
+                         du, amrex::Math::abs(uo(i,j,k,0)),
+                         dv, amrex::Math::abs(uo(i,j,k,1)),
+                         dw, amrex::Math::abs(uo(i,j,k,2)) };
+#else
+                return { amrex::max(du,dv),
+                         du, amrex::Math::abs(uo(i,j,k,0)),
+                         dv, amrex::Math::abs(uo(i,j,k,1)) };
+#endif
+            });
+        }
+
+        auto hv = reduce_data.value();
+        double* v = &sums[nsums*lev];
+        maxs[lev] = amrex::get<0>(hv);
+        v[0] = amrex::get<1>(hv);
+        v[1] = amrex::get<2>(hv);
+        v[2] = amrex::get<3>(hv);
+        v[3] = amrex::get<4>(hv);
+#if (AMREX_SPACEDIM == 3)
+        v[4] = amrex::get<5>(hv);
+        v[5] = amrex::get<6>(hv);
+#endif
+    }
 
-            // sum(abs(u^{n+1}-u^n)) / sum(abs(u^n))
-            // TODO: this gives zero often, check for bug
-            Real norm1_diff = Norm(diff_vel, lev, i, 1);
-            Real norm1_old = Norm(vel_o, lev, i, 1);
-            Real relchange = norm1_old > 1.0e-15 ? norm1_diff / norm1_old : 0.0;
+    ParallelAllReduce::Max(maxs.data(), maxs.size(), ParallelContext::CommunicatorSub());
+    ParallelAllReduce::Sum(sums.data(), sums.size(), ParallelContext::CommunicatorSub());
+
+    bool reached = true;
+    for (int lev = 0; lev <= finest_level; lev++)
+    {
+        double const* v = &sums[nsums*lev];
+        const double max_change = maxs[lev];
+
+        // sum(abs(u^{n+1}-u^n)) / sum(abs(u^n)), largest over the components
+        double max_relchange = 0.0;
+        for (int n = 0; n < AMREX_SPACEDIM; ++n) {
+            const double norm1_diff = v[2*n];
+            const double norm1_old  = v[2*n+1];
+            const double relchange = norm1_old > 1.0e-15 ? norm1_diff / norm1_old : 0.0;
             max_relchange = amrex::max(max_relchange, relchange);
         }
 
-        condition1[lev] = (max_change < m_steady_state_tol * dt);
-        condition2[lev] = (max_relchange < m_steady_state_tol);
+        const bool condition1 = (max_change < m_steady_state_tol * m_dt);
+        const bool condition2 = (max_relchange < m_steady_state_tol);
 
         // Print out info on steady state checks
         if (m_verbose > 0)
         {
-            amrex::Print() << "\nSteady state check level " << lev << std::endl; 
+            amrex::Print() << "\nSteady state check level " << lev << std::endl;
             amrex::Print() << "||u-uo||/||uo|| = " << max_relchange
-                           << ", du/dt  = " << max_change/dt << std::endl;
+                           << ", du/dt  = " << max_change/m_dt << std::endl;
         }
-    }
 
-    bool reached = true;
-    for(int lev = 0; lev <= finest_level; lev++)
-    {
-        reached = reached && (condition1[lev] || condition2[lev]);
+        reached = reached && (condition1 || condition2);
     }
 
-    // Always return negative to first access. This way
-    // initial zero velocity field do not test for false positive
-    if(m_nstep < 2)
-    {
-        return false;
-    } else {
-        return reached;
-    }
-#endif
+    return reached;
 }
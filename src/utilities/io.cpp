@@ -63,6 +63,11 @@ void incflo::WriteHeader(const std::string& name, bool is_checkpoint) const
             boxArray(lev).writeOn(HeaderFile);
             HeaderFile << '\n';
         }
+
+        // Time over which the running statistics have been averaged
+        if(is_checkpoint) {
+            HeaderFile << m_stats_time << "\n";
+        }
     }
 }
 
@@ -98,6 +103,11 @@ void incflo::WriteCheckPointFile() const
 
         VisMF::Write(m_leveldata[lev]->p,
                      amrex::MultiFabFileFullPrefix(lev, checkpointname, level_prefix, "p"));
+
+        if (m_stats_int > 0) {
+            VisMF::Write(m_stats[lev],
+                         amrex::MultiFabFileFullPrefix(lev, checkpointname, level_prefix, "stats"));
+        }
     }
 }
 
@@ -197,6 +207,11 @@ void incflo::ReadCheckpointFile()
         MakeNewLevelFromScratch(lev, m_cur_time, ba, dm);
     }
 
+    // Averaging time of the running statistics (absent in older checkpoints)
+    if (!(is >> m_stats_time)) {
+        m_stats_time = 0.0;
+    }
+
     /***************************************************************************
      * Load fluid data                                                         *
      ***************************************************************************/
@@ -204,22 +219,34 @@ void incflo::ReadCheckpointFile()
     // Load the field data
     for(int lev = 0; lev <= finest_level; ++lev)
     {
-        VisMF::Read(m_leveldata[lev]->velocity,
-                    amrex::MultiFabFileFullPrefix(lev, m_restart_file, level_prefix, "velocity"));
+        ReadCheckpointMultiFab(m_leveldata[lev]->velocity,
+                               amrex::MultiFabFileFullPrefix(lev, m_restart_file, level_prefix, "velocity"));
 
-        VisMF::Read(m_leveldata[lev]->density,
-                    amrex::MultiFabFileFullPrefix(lev, m_restart_file, level_prefix, "density"));
+        ReadCheckpointMultiFab(m_leveldata[lev]->density,
+                               amrex::MultiFabFileFullPrefix(lev, m_restart_file, level_prefix, "density"));
 
         if (m_ntrac > 0) {
-            VisMF::Read(m_leveldata[lev]->tracer,
-                        amrex::MultiFabFileFullPrefix(lev, m_restart_file, level_prefix, "tracer"));
+            ReadCheckpointMultiFab(m_leveldata[lev]->tracer,
+                                   amrex::MultiFabFileFullPrefix(lev, m_restart_file, level_prefix, "tracer"));
         }
 
-        VisMF::Read(m_leveldata[lev]->gp,
-                    amrex::MultiFabFileFullPrefix(lev, m_restart_file, level_prefix, "gradp"));
+        ReadCheckpointMultiFab(m_leveldata[lev]->gp,
+                               amrex::MultiFabFileFullPrefix(lev, m_restart_file, level_prefix, "gradp"));
 
-        VisMF::Read(m_leveldata[lev]->p,
-                    amrex::MultiFabFileFullPrefix(lev, m_restart_file, level_prefix, "p"));
+        ReadCheckpointMultiFab(m_leveldata[lev]->p,
+                               amrex::MultiFabFileFullPrefix(lev, m_restart_file, level_prefix, "p"));
+
+        // Start the averages afresh if the checkpoint was written without statistics
+        if (m_stats_int > 0)
+        {
+            const std::string stats_file =
+                amrex::MultiFabFileFullPrefix(lev, m_restart_file, level_prefix, "stats");
+            if (amrex::FileExists(stats_file + "_H")) {
+                ReadCheckpointMultiFab(m_stats[lev], stats_file);
+            } else {
+                m_stats_time = 0.0;
+            }
+        }
     }
 
     amrex::Print() << "Restart complete" << std::endl;
@@ -503,7 +530,11 @@ void incflo::WritePlotFile()
         ++icomp;
     }
     if (m_plt_divu) {
-        amrex::Abort("plt_divu: xxxxx TODO");
+        Vector<MultiFab> divu;
+        for (int lev = 0; lev <= finest_level; ++lev) {
+            divu.emplace_back(mf[lev], amrex::make_alias, icomp, 1);
+        }
+        ComputeDivU(GetVecOfPtrs(divu), m_cur_time);
         pltscaVarsName.push_back("divu");
         ++icomp;
     }